@@ -5,7 +5,7 @@
 
 #
 # This module looks for fftw.
-# It sets up : FFTW_INCLUDE_DIR, FFTW_LIBRARIES
+# It sets up : FFTW_INCLUDE_DIR, FFTW_LIBRARIES, and FFTW_THREADS_LIBRARIES if found
 # 
 
 SET(TRIAL_PATHS
@@ -31,8 +31,12 @@ SET(FFTW_LIBRARIES "FFTW_LIBRARIES-NOTFOUND" CACHE STRING "FFTW library")
 # Try to detect the lib
 FIND_LIBRARY(FFTW_LIBRARIES fftw3 ${TRIAL_LIBRARY_PATHS} DOC "FFTW library")
 
+# Optional : the threaded version of the library
+FIND_LIBRARY(FFTW_THREADS_LIBRARIES fftw3_threads ${TRIAL_LIBRARY_PATHS} DOC "FFTW threads library")
+
 mark_as_advanced(FFTW_INCLUDE_DIR)
 mark_as_advanced(FFTW_LIBRARIES)
+mark_as_advanced(FFTW_THREADS_LIBRARIES)
 
 FIND_PACKAGE_HANDLE_STANDARD_ARGS(FFTW DEFAULT_MSG FFTW_LIBRARIES FFTW_INCLUDE_DIR)
 
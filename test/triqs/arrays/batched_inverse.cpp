@@ -0,0 +1,69 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2011 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "start.hpp"
+#include <triqs/arrays/linalg/batched_inverse.hpp>
+
+double make_value(double x, double y, double) { return x; }
+std::complex<double> make_value(double x, double y, std::complex<double>) { return {x, y}; }
+
+// Compare with the inverse of each matrix
+template <typename T> void check(int n, int n_mat) {
+ array<T, 3> a(n_mat, n, n);
+ for (int i = 0; i < n_mat; ++i)
+  for (int j = 0; j < n; ++j)
+   for (int k = 0; k < n; ++k)
+    a(i, j, k) = make_value(std::cos(1 + i + 3 * j + 7 * k * k), std::sin(i + j - k), T{}) + (j == k ? T(n) : T(0));
+
+ auto b = a;
+ batched_inverse_in_place(b);
+ for (int i = 0; i < n_mat; ++i) {
+  matrix<T> m = a(i, range(), range());
+  EXPECT_ARRAY_NEAR(matrix<T>(inverse(m)), b(i, range(), range()), 1e-12);
+ }
+
+ // On a non contiguous view
+ array<T, 3> c(n_mat, n + 1, n + 1);
+ c() = 0;
+ auto v = c(range(), range(0, n), range(1, n + 1));
+ v = a;
+ batched_inverse_in_place(v);
+ EXPECT_ARRAY_NEAR(b, v, 1e-12);
+}
+
+TEST(BatchedInverse, Double) {
+ for (int n = 1; n < 8; ++n) check<double>(n, 50);
+}
+
+TEST(BatchedInverse, Complex) {
+ for (int n = 1; n < 8; ++n) check<std::complex<double>>(n, 50);
+}
+
+TEST(BatchedInverse, Singular) {
+ for (int n = 1; n < 6; ++n) {
+  array<double, 3> a(20, n, n);
+  a() = 1;
+  for (int i = 0; i < 20; ++i)
+   for (int j = 0; j < n; ++j) a(i, j, j) = 2;
+  a(13, range(), range()) = 0;
+  EXPECT_THROW(batched_inverse_in_place(a), matrix_inverse_exception);
+ }
+}
+MAKE_MAIN
@@ -0,0 +1,91 @@
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/arrays.hpp>
+#include <triqs/arrays/h5/mapped_read.hpp>
+#include <hdf5.h>
+using namespace triqs::arrays;
+namespace h5 = triqs::h5;
+
+array<dcomplex, 3> make_array() {
+ array<dcomplex, 3> a(50, 3, 4);
+ for (int i = 0; i < 50; ++i)
+  for (int j = 0; j < 3; ++j)
+   for (int k = 0; k < 4; ++k) a(i, j, k) = dcomplex(i + 0.1 * j, k - i);
+ return a;
+}
+
+TEST(H5Mapped, Contiguous) {
+ auto a = make_array();
+ array<double, 2> b{{1, 2, 3}, {4, 5, 6}};
+ {
+  h5::file f("mapped.h5", 'w');
+  h5::group top(f);
+  h5_write(top, "a", a);
+  h5_write(top, "b", b);
+  h5_write(top, "i", array<long, 1>{1, 2, 3});
+ }
+ array_const_view<dcomplex, 3> va = array<dcomplex, 3>{}; // to check the rebind
+ {
+  h5::file f("mapped.h5", 'r');
+  h5::group top(f);
+  EXPECT_TRUE(h5_can_map<dcomplex>(top, "a"));
+  EXPECT_TRUE(h5_can_map<double>(top, "b"));
+  EXPECT_FALSE(h5_can_map<long>(top, "b")); // other type
+  EXPECT_FALSE(h5_can_map<double>(top, "a")); // complex
+  va.rebind(h5_read_mapped<dcomplex, 3>(top, "a"));
+  auto vb = h5_read_mapped<double, 2>(top, "b");
+  EXPECT_ARRAY_EQ(b, vb);
+  auto vi = h5_read_mapped<long, 1>(top, "i");
+  EXPECT_EQ(3, vi(2));
+  EXPECT_THROW((h5_read_mapped<double, 3>(top, "b")), triqs::runtime_error);
+ }
+ // the mapping outlives the file
+ EXPECT_ARRAY_EQ(a, va);
+ array<dcomplex, 2> s = va(10, range(), range());
+ array<dcomplex, 2> s0 = a(10, range(), range());
+ EXPECT_ARRAY_EQ(s0, s);
+ array<dcomplex, 3> copy = va;
+ EXPECT_ARRAY_EQ(a, copy);
+}
+
+TEST(H5Mapped, WrittenInTheSameFile) {
+ auto a = make_array();
+ h5::file f("mapped_rw.h5", 'w');
+ h5::group top(f);
+ h5_write(top, "a", a);
+ auto va = h5_read_mapped<dcomplex, 3>(top, "a"); // flushes the file first
+ EXPECT_ARRAY_EQ(a, va);
+}
+
+TEST(H5Mapped, Fallback) {
+ auto a = make_array();
+ {
+  h5::file f("mapped_deflate.h5", 'w');
+  h5::write_policy p;
+  p.deflate_level = 1;
+  p.min_bytes = 0;
+  f.set_write_policy(p);
+  h5_write(h5::group(f), "a", a);
+ }
+ h5::file f("mapped_deflate.h5", 'r');
+ EXPECT_FALSE(h5_can_map<dcomplex>(h5::group(f), "a")); // chunked
+ auto va = h5_read_mapped<dcomplex, 3>(h5::group(f), "a");
+ EXPECT_ARRAY_EQ(a, va);
+}
+
+TEST(H5Mapped, Misaligned) {
+ // HDF5 packs the raw data of small datasets : b starts just after the 3 bytes of s
+ array<double, 1> b{1, 2, 3, 4};
+ {
+  h5::file f("mapped_misaligned.h5", 'w');
+  h5_write(h5::group(f), "s", std::string("ab"));
+  h5_write(h5::group(f), "b", b);
+ }
+ h5::file f("mapped_misaligned.h5", 'r');
+ auto ds = h5::group(f).open_dataset("b");
+ ASSERT_NE(0, H5Dget_offset(ds) % alignof(double));
+ EXPECT_FALSE(h5_can_map<double>(h5::group(f), "b"));
+ auto vb = h5_read_mapped<double, 1>(h5::group(f), "b");
+ EXPECT_ARRAY_EQ(b, vb);
+}
+
+MAKE_MAIN;
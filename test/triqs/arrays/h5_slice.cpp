@@ -0,0 +1,87 @@
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/arrays.hpp>
+using namespace triqs::arrays;
+namespace h5 = triqs::h5;
+
+template <typename T> array<T, 3> make_array() {
+ array<T, 3> a(20, 4, 6);
+ for (int i = 0; i < 20; ++i)
+  for (int j = 0; j < 4; ++j)
+   for (int k = 0; k < 6; ++k) a(i, j, k) = T(100 * i + 10 * j + k);
+ return a;
+}
+
+TEST(H5Slice, Read) {
+ auto a = make_array<double>();
+ auto ac = make_array<dcomplex>();
+ ac *= dcomplex(1, 2);
+ {
+  h5::file f("h5_slice_read.h5", 'w');
+  h5_write(h5::group(f), "a", a);
+  h5_write(h5::group(f), "ac", ac);
+ }
+ h5::file f("h5_slice_read.h5", 'r');
+ h5::group top(f);
+
+ array<double, 2> b;
+ h5_read_slice(top, "a", b, 5, range(), range());
+ EXPECT_ARRAY_EQ(b, a(5, range(), range()));
+
+ array<double, 3> c;
+ h5_read_slice(top, "a", c, range(2, 18, 3), range(1, 3), range(0, 6, 2));
+ EXPECT_ARRAY_EQ(c, a(range(2, 18, 3), range(1, 3), range(0, 6, 2)));
+
+ array<double, 1> d;
+ h5_read_slice(top, "a", d, range(), 2, 3);
+ EXPECT_ARRAY_EQ(d, a(range(), 2, 3));
+
+ array<dcomplex, 2> e;
+ h5_read_slice(top, "ac", e, range(4, 10), 1, range());
+ EXPECT_ARRAY_EQ(e, ac(range(4, 10), 1, range()));
+
+ // into a non contiguous view
+ array<dcomplex, 2> big(10, 12);
+ big() = 0;
+ h5_read_slice(top, "ac", big(range(0, 10, 2), range(0, 12, 2)), range(0, 5), 3, range());
+ EXPECT_ARRAY_EQ(big(range(0, 10, 2), range(0, 12, 2)), ac(range(0, 5), 3, range()));
+ EXPECT_EQ(big(1, 1), dcomplex(0));
+
+ // a real dataset read into a complex array
+ array<dcomplex, 2> f2, f2_ref = a(7, range(), range());
+ h5_read_slice(top, "a", f2, 7, range(), range());
+ EXPECT_ARRAY_EQ(f2, f2_ref);
+
+ // errors
+ EXPECT_THROW(h5_read_slice(top, "a", b, 20, range(), range()), triqs::runtime_error);
+ EXPECT_THROW(h5_read_slice(top, "a", b, 5, range()), triqs::runtime_error);
+ EXPECT_THROW(h5_read_slice(top, "a", d, range(), range(), 1), triqs::runtime_error);
+ array<double, 2> wrong(3, 3);
+ EXPECT_THROW(h5_read_slice(top, "a", wrong(), 5, range(), range()), triqs::runtime_error);
+}
+
+TEST(H5Slice, Write) {
+ auto a = make_array<dcomplex>();
+ {
+  h5::file f("h5_slice_write.h5", 'w');
+  h5::group top(f);
+  h5_create_array_dataset<dcomplex>(top, "a", mini_vector<size_t, 3>{20, 4, 6});
+  for (int i = 0; i < 20; ++i) h5_write_slice(top, "a", a(i, range(), range()), i, range(), range());
+  h5_write(top, "b", make_array<double>());
+  auto x = array<double, 1>{-1, -2, -3, -4};
+  h5_write_slice(top, "b", x, 0, range(), 5);
+  EXPECT_THROW(h5_write_slice(top, "b", a(0, range(), range()), 0, range(), range()), triqs::runtime_error); // complex in real
+  EXPECT_THROW(h5_write_slice(top, "b", x, 0, 1, range()), triqs::runtime_error);                          // shape
+ }
+ h5::file f("h5_slice_write.h5", 'r');
+ array<dcomplex, 3> r;
+ h5_read(h5::group(f), "a", r);
+ EXPECT_ARRAY_EQ(r, a);
+
+ auto b = make_array<double>();
+ b(0, range(), 5) = array<double, 1>{-1, -2, -3, -4};
+ array<double, 3> rb;
+ h5_read(h5::group(f), "b", rb);
+ EXPECT_ARRAY_EQ(rb, b);
+}
+
+MAKE_MAIN;
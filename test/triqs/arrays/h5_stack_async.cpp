@@ -0,0 +1,114 @@
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/arrays.hpp>
+#include <triqs/arrays/h5/array_stack.hpp>
+#include <triqs/h5/base.hpp>
+#include <memory>
+using namespace triqs::arrays;
+namespace h5 = triqs::h5;
+
+const int N = 1003, d = 3;
+
+array<dcomplex, 2> element(int u) {
+ array<dcomplex, 2> a(d, d);
+ for (int i = 0; i < d; ++i)
+  for (int j = 0; j < d; ++j) a(i, j) = dcomplex(u * (i == j), 0.1 * u * (i - j));
+ return a;
+}
+
+// write N elements and a scalar series, and read them back
+void write_and_check(std::string const& filename, array_stack_mode mode, size_t chunk_size, int deflate_level) {
+ {
+  h5::file f(filename, 'w');
+  h5::write_policy p;
+  p.deflate_level = deflate_level;
+  f.set_write_policy(p);
+  h5::group top(f);
+  array_stack<array<dcomplex, 2>> SA(top, "A", mini_vector<size_t, 2>(d, d), 64, mode, chunk_size);
+  array_stack<double> SC(top, "C", 64, mode, chunk_size);
+  // async only with a thread safe HDF5 library
+  auto expected_mode = (h5::library_is_threadsafe() ? mode : array_stack_mode::sync);
+  EXPECT_TRUE(expected_mode == SA.get_mode());
+  for (int u = 0; u < N; ++u) {
+   SA << element(u);
+   SC() = 0.5 * u;
+   ++SC;
+  }
+  EXPECT_EQ(N, SA.size());
+ }
+ h5::file f(filename, 'r');
+ h5::group top(f);
+ array<dcomplex, 3> A;
+ array<double, 1> C;
+ h5_read(top, "A", A);
+ h5_read(top, "C", C);
+ ASSERT_EQ(N, first_dim(A));
+ ASSERT_EQ(N, first_dim(C));
+ for (int u = 0; u < N; ++u) {
+  array<dcomplex, 2> a = A(u, range(), range());
+  EXPECT_ARRAY_EQ(element(u), a);
+  EXPECT_EQ(0.5 * u, C(u));
+ }
+
+ // chunk along the stack
+ auto ds = top.open_dataset("A");
+ h5::proplist pl = H5Dget_create_plist(ds);
+ hsize_t chunk[4];
+ EXPECT_EQ(4, H5Pget_chunk(pl, 4, chunk));
+ EXPECT_EQ((chunk_size > 0 ? chunk_size : 64), chunk[0]);
+ EXPECT_EQ(d, chunk[1]);
+ EXPECT_EQ(2, chunk[3]);
+ EXPECT_EQ((deflate_level > 0 ? 1 : 0), H5Pget_nfilters(pl));
+}
+
+TEST(ArrayStack, Sync) { write_and_check("stack_sync.h5", array_stack_mode::sync, 0, 0); }
+TEST(ArrayStack, Async) { write_and_check("stack_async.h5", array_stack_mode::async, 0, 0); }
+TEST(ArrayStack, AsyncChunkedDeflate) { write_and_check("stack_async_deflate.h5", array_stack_mode::async, 256, 4); }
+
+// The default chunk (the buffer) is capped to about chunk_bytes
+TEST(ArrayStack, DefaultChunkCapped) {
+ h5::file f("stack_chunk_cap.h5", 'w');
+ h5::write_policy p;
+ p.chunk_bytes = 4096;
+ f.set_write_policy(p);
+ h5::group top(f);
+ { array_stack<array<double, 1>> S(top, "S", mini_vector<size_t, 1>(64), 100); } // 512 bytes per element
+ h5::proplist pl = H5Dget_create_plist(top.open_dataset("S"));
+ hsize_t chunk[2];
+ EXPECT_EQ(2, H5Pget_chunk(pl, 2, chunk));
+ EXPECT_EQ(8, chunk[0]);
+ EXPECT_EQ(64, chunk[1]);
+}
+
+TEST(ArrayStack, AsyncExplicitFlush) {
+ h5::file f("stack_async_flush.h5", 'w');
+ array_stack<long> S(h5::group(f), "S", 10, array_stack_mode::async);
+ for (long u = 0; u < 25; ++u) S << u;
+ S.flush(); // everything is on disk here
+ array<long, 1> r;
+ h5_read(h5::group(f), "S", r);
+ ASSERT_EQ(25, first_dim(r));
+ for (long u = 0; u < 25; ++u) EXPECT_EQ(u, r(u));
+ S << 25;
+}
+
+// The datasets of the file are closed behind the back of the stack : its next write fails.
+// The error is thrown by flush, and only reported by the destructor.
+void check_write_error(array_stack_mode mode) {
+ h5::file f("stack_error.h5", 'w');
+ auto S = std::make_unique<array_stack<double>>(h5::group(f), "S", 10, mode);
+ *S << 1.0;
+ hid_t ids[10];
+ auto n = H5Fget_obj_ids(f, H5F_OBJ_DATASET, 10, ids);
+ for (int i = 0; i < n; ++i) H5Dclose(ids[i]);
+ EXPECT_THROW(S->flush(), triqs::runtime_error);
+ *S << 2.0;
+ EXPECT_NO_THROW(S.reset());
+}
+
+TEST(ArrayStack, WriteError) {
+ H5Eset_auto2(H5E_DEFAULT, NULL, NULL); // no HDF5 error stack on the output
+ check_write_error(array_stack_mode::sync);
+ check_write_error(array_stack_mode::async);
+}
+
+MAKE_MAIN;
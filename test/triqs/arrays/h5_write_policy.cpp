@@ -0,0 +1,78 @@
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/arrays.hpp>
+#include <hdf5.h>
+#include <fstream>
+using namespace triqs::arrays;
+namespace h5 = triqs::h5;
+
+long file_size(std::string const& name) { return std::ifstream(name, std::ios::binary | std::ios::ate).tellg(); }
+
+// number of filters of a dataset, -1 if it is not chunked
+int n_filters(h5::group g, std::string const& name) {
+ auto ds = g.open_dataset(name);
+ h5::proplist pl = H5Dget_create_plist(ds);
+ if (H5Pget_layout(pl) != H5D_CHUNKED) return -1;
+ return H5Pget_nfilters(pl);
+}
+
+array<dcomplex, 3> make_array() {
+ array<dcomplex, 3> a(200, 10, 10);
+ for (int i = 0; i < 200; ++i)
+  for (int j = 0; j < 10; ++j)
+   for (int k = 0; k < 10; ++k) a(i, j, k) = dcomplex(std::exp(-0.01 * i) * (j == k), 0.001 * i * j);
+ return a;
+}
+
+TEST(H5WritePolicy, Deflate) {
+ auto a = make_array();
+ {
+  h5::file f("write_policy_plain.h5", 'w');
+  h5_write(h5::group(f), "a", a);
+ }
+ {
+  h5::file f("write_policy_deflate.h5", 'w');
+  h5::write_policy p;
+  p.deflate_level = 6;
+  p.shuffle = true;
+  f.set_write_policy(p);
+  h5::group top(f);
+  h5_write(top, "a", a);
+  auto sub = top.create_group("sub"); // inherited
+  h5_write(sub, "a", a);
+  h5_write(sub, "small", array<double, 1>{1.0, 2.0}); // too small : contiguous
+  EXPECT_EQ(n_filters(top, "a"), 2);
+  EXPECT_EQ(n_filters(sub, "a"), 2);
+  EXPECT_EQ(n_filters(sub, "small"), -1);
+ }
+ EXPECT_LT(file_size("write_policy_deflate.h5"), file_size("write_policy_plain.h5") / 2);
+
+ h5::file f("write_policy_deflate.h5", 'r');
+ array<dcomplex, 3> b;
+ h5_read(h5::group(f), "a", b);
+ EXPECT_ARRAY_EQ(a, b);
+ h5_read(h5::group(f).open_group("sub"), "a", b);
+ EXPECT_ARRAY_EQ(a, b);
+}
+
+TEST(H5WritePolicy, ScaleOffset) {
+ auto a = make_array();
+ {
+  h5::file f("write_policy_so.h5", 'w');
+  h5::group top(f);
+  h5::write_policy p;
+  p.scale_offset_digits = 4;
+  top.set_write_policy(p);
+  h5_write(top, "a", a);
+  array<long, 2> l(200, 100);
+  l() = 3;
+  h5_write(top, "l", l); // integers are not packed : only chunked
+  EXPECT_EQ(n_filters(top, "a"), 1);
+  EXPECT_EQ(n_filters(top, "l"), 0);
+ }
+ h5::file f("write_policy_so.h5", 'r');
+ array<dcomplex, 3> b;
+ h5_read(h5::group(f), "a", b);
+ EXPECT_ARRAY_NEAR(a, b, 1.e-4);
+}
+
+MAKE_MAIN;
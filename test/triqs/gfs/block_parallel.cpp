@@ -0,0 +1,60 @@
+#include <triqs/test_tools/gfs.hpp>
+
+double beta = 1;
+
+// blocks of very different sizes
+block_gf<imfreq> make_block(std::vector<int> const& sizes) {
+ std::vector<gf<imfreq>> v;
+ for (int n : sizes) {
+  auto g = gf<imfreq>{{beta, Fermion, 100}, {n, n}};
+  for (auto const& w : g.mesh()) {
+   g[w] = 0;
+   for (int i = 0; i < n; ++i) g[w](i, i) = 1 / (w - 0.1 * (i + 1));
+  }
+  g.singularity()(1) = 1;
+  v.push_back(g);
+ }
+ return make_block_gf(v);
+}
+
+TEST(BlockParallel, Inverse) {
+ auto B = make_block({1, 5, 2, 8, 1, 3});
+ auto inv_B = inverse(B);
+ for (int b = 0; b < n_blocks(B); ++b) EXPECT_GF_NEAR(inv_B[b], inverse(B[b]));
+
+ auto B2 = B;
+ invert_in_place(B2());
+ for (int b = 0; b < n_blocks(B); ++b) EXPECT_GF_NEAR(inv_B[b], B2[b]);
+}
+
+TEST(BlockParallel, Map) {
+ auto B = make_block({1, 5, 2, 8});
+ auto f = [](gf_const_view<imfreq> g) { return matrix<dcomplex>(g.data()(0, range(), range())); };
+ auto r = map_block_gf(f, B, block_execution::parallel);
+ auto r_s = map_block_gf(f, B);
+ EXPECT_EQ(r.size(), 4);
+ for (int b = 0; b < 4; ++b) EXPECT_ARRAY_NEAR(r[b], r_s[b], 1.e-15);
+}
+
+TEST(BlockParallel, Assign) {
+ auto B = make_block({1, 5, 2, 8});
+ auto B2 = B;
+ B2() = 2 * B;
+ for (int b = 0; b < 4; ++b) EXPECT_ARRAY_NEAR(B2[b].data(), 2 * B[b].data(), 1.e-14);
+
+ auto B3 = make_block({1, 5, 2, 7});
+ EXPECT_THROW(B3() = B, triqs::runtime_error);
+}
+
+TEST(BlockParallel, Exception) {
+ int n_done = 0;
+ auto f = [&](long i) {
+  if (i == 3) TRIQS_RUNTIME_ERROR << "block " << i;
+#pragma omp atomic
+  ++n_done;
+ };
+ EXPECT_THROW(for_each_block(10, f), triqs::runtime_error);
+ EXPECT_EQ(n_done, 9);
+}
+
+MAKE_MAIN;
@@ -0,0 +1,64 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/gfs.hpp>
+
+using namespace triqs::gfs;
+using triqs::arrays::matrix;
+
+double beta = 10, mu = 0.3;
+
+matrix<double> make_eps(int n) {
+ matrix<double> eps(n, n);
+ for (int i = 0; i < n; ++i)
+  for (int j = 0; j < n; ++j) eps(i, j) = (i == j ? 0.1 * i : 0.2 / (1 + i + j));
+ return eps;
+}
+
+// A self-energy with a non trivial data and tail
+gf<imfreq> make_sigma(int n) {
+ auto sigma = gf<imfreq>{{beta, Fermion, 50}, {n, n}};
+ for (auto const& w : sigma.mesh()) {
+  matrix<dcomplex> m = make_eps(n) * 0.5;
+  sigma[w] = m / (dcomplex(w) - 1.5);
+ }
+ sigma.singularity()(1) = make_eps(n) * 0.5;
+ return sigma;
+}
+
+// The reference : g = (iw + mu - eps - sigma)^-1 point by point, and the tail algebra
+gf<imfreq> reference(matrix<double> const& eps, gf<imfreq> const& sigma) {
+ auto g = sigma;
+ int n = first_dim(eps);
+ for (auto const& w : g.mesh()) {
+  matrix<dcomplex> m = (dcomplex(w) + mu) * triqs::arrays::make_unit_matrix<dcomplex>(n) - eps - sigma[w];
+  g[w] = matrix<dcomplex>(inverse(m));
+ }
+ auto const& ts = sigma.singularity();
+ g.singularity() = inverse(tail_omega(ts) + mu - eps - ts);
+ return g;
+}
+
+TEST(Gf, Dyson) {
+ for (int n = 1; n < 7; ++n) {
+  auto eps = make_eps(n);
+  auto sigma = make_sigma(n);
+  auto ref = reference(eps, sigma);
+  auto g = gf<imfreq>{sigma.mesh(), {n, n}};
+  dyson(g, mu, eps, sigma);
+  EXPECT_GF_NEAR(ref, g, 1e-12);
+  // in place, the result replacing sigma
+  dyson(sigma(), mu, eps, sigma());
+  EXPECT_GF_NEAR(ref, sigma, 1e-12);
+ }
+}
+
+TEST(BlockGf, Dyson) {
+ std::vector<matrix<double>> eps = {make_eps(2), make_eps(5), make_eps(1)};
+ auto sigma = make_block_gf<imfreq>({"a", "b", "c"}, {make_sigma(2), make_sigma(5), make_sigma(1)});
+ auto g = sigma;
+ dyson(g, mu, eps, sigma);
+ for (int b = 0; b < 3; ++b) EXPECT_GF_NEAR(reference(eps[b], sigma[b]), g[b], 1e-12);
+ // size mismatch
+ eps.pop_back();
+ EXPECT_THROW(dyson(g, mu, eps, sigma), triqs::runtime_error);
+}
+MAKE_MAIN;
@@ -0,0 +1,70 @@
+#include <triqs/test_tools/gfs.hpp>
+
+double beta = 2;
+
+// A smooth 2x2 function of tau
+matrix<dcomplex> f(double t) {
+ matrix<dcomplex> m(2, 2);
+ m(0, 0) = std::exp(-t);
+ m(0, 1) = 1_j * std::sin(t);
+ m(1, 0) = 0.5 * t;
+ m(1, 1) = std::cos(2 * t);
+ return m;
+}
+
+gf<imtime> make_gt(int n_tau) {
+ auto gt = gf<imtime>{{beta, Fermion, n_tau}, {2, 2}};
+ for (auto const& t : gt.mesh()) gt[t] = f(t);
+ return gt;
+}
+
+TEST(EvaluateMany, SameAsCall) {
+ auto gt = make_gt(101);
+ int n = 57;
+ array<double, 1> taus(n);
+ for (int k = 0; k < n; ++k) taus(k) = -beta + 3 * beta * k / (n - 1.0); // with the antiperiodicity
+ auto res = evaluate_many(gt, taus);
+ for (int k = 0; k < n; ++k) EXPECT_ARRAY_NEAR(matrix<dcomplex>(gt(taus(k))), matrix<dcomplex>(res(k, range(), range())), 1.e-14);
+
+ auto gw = gf<refreq, scalar_valued>{{-5, 5, 201}};
+ for (auto const& w : gw.mesh()) gw[w] = 1 / (w + 0.1_j);
+ array<double, 1> ws{-5.0, -1.37, 0.0, 0.013, 4.999, 5.0};
+ auto res_w = evaluate_many(gw, ws);
+ for (int k = 0; k < first_dim(ws); ++k) EXPECT_CLOSE(gw(ws(k)), res_w(k));
+
+ EXPECT_THROW(evaluate_many(gw, array<double, 1>{0.0, 5.1}), triqs::runtime_error);
+}
+
+TEST(EvaluateMany, StridedResult) {
+ auto gt = make_gt(101);
+ array<double, 1> taus{0.1, 0.7, 1.9};
+ auto out = array<dcomplex, 3>(3, 3, 3);
+ out() = 0;
+ evaluate_many(gt, taus, out(range(), range(1, 3), range(0, 3, 2)));
+ EXPECT_ARRAY_NEAR(evaluate_many(gt, taus), out(range(), range(1, 3), range(0, 3, 2)), 1.e-14);
+ EXPECT_EQ(0, max_element(abs(out(range(), 0, range()))));
+}
+
+TEST(EvaluateMany, Cubic) {
+ auto gt = make_gt(51);
+ int n = 40;
+ array<double, 1> taus(n);
+ for (int k = 0; k < n; ++k) taus(k) = 0.013 + (beta - 0.026) * k / (n - 1.0);
+ auto lin = evaluate_many(gt, taus);
+ auto cub = evaluate_many(gt, taus, interpol_t::Cubic1d{});
+ auto exact = array<dcomplex, 3>(n, 2, 2);
+ for (int k = 0; k < n; ++k) {
+  exact(k, range(), range()) = f(taus(k));
+ }
+ EXPECT_ARRAY_NEAR(exact, lin, 1.e-3);
+ EXPECT_ARRAY_NEAR(exact, cub, 1.e-5);
+ EXPECT_GT(max_element(abs(exact - lin)), 1.e-4);
+
+ // antiperiodicity
+ array<double, 1> ones(n);
+ ones() = 1;
+ auto cub_m = evaluate_many(gt, array<double, 1>(taus - beta * ones), interpol_t::Cubic1d{});
+ EXPECT_ARRAY_NEAR(cub, -cub_m, 1.e-14);
+}
+
+MAKE_MAIN;
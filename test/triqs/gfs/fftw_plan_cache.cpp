@@ -0,0 +1,69 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/gfs.hpp>
+#include <triqs/gfs/transform/fftw_plan_cache.hpp>
+#include <atomic>
+#include <thread>
+
+using namespace triqs::gfs;
+
+double beta = 1;
+int n_iw = 50;
+triqs::clef::placeholder<0> om_;
+
+TEST(Fourier, PlanCache) {
+ namespace fftw = triqs::gfs::fftw;
+ fftw::clear_plan_cache();
+ EXPECT_EQ(0, fftw::plan_cache_size());
+
+ auto gw = gf<imfreq>{{beta, Fermion, n_iw}, {2, 2}};
+ gw(om_) << 1 / (om_ - 1.2);
+ auto gt = gf<imtime>{{beta, Fermion, 2 * n_iw + 1}, {2, 2}};
+
+ gt() = inverse_fourier(gw);
+ long n_plans = fftw::plan_cache_size();
+ EXPECT_TRUE(n_plans > 0);
+
+ // Same geometry : the plans are reused
+ auto gt2 = gt;
+ for (int i = 0; i < 3; ++i) gt2() = inverse_fourier(gw);
+ EXPECT_EQ(n_plans, fftw::plan_cache_size());
+ EXPECT_GF_NEAR(gt, gt2);
+
+ // The planning with measure must not touch the data
+ fftw::clear_plan_cache();
+ fftw::set_planner_rigor(fftw::planner_rigor::measure);
+ fftw::set_n_threads(2);
+ auto gw2 = gw;
+ gw2() = fourier(gt);
+ EXPECT_GF_NEAR(gw, gw2, 1e-9);
+ gt2() = inverse_fourier(gw);
+ EXPECT_GF_NEAR(gt, gt2);
+ fftw::set_planner_rigor(fftw::planner_rigor::estimate);
+ fftw::set_n_threads(1);
+
+ // Wisdom
+ EXPECT_TRUE(fftw::export_wisdom("fftw_plan_cache.wisdom"));
+ EXPECT_TRUE(fftw::import_wisdom("fftw_plan_cache.wisdom"));
+ EXPECT_FALSE(fftw::import_wisdom("no_such_dir/no_such_file.wisdom"));
+}
+TEST(Fourier, ClearWhileExecuting) {
+ namespace fftw = triqs::gfs::fftw;
+ auto gw = gf<imfreq>{{beta, Fermion, n_iw}, {2, 2}};
+ gw(om_) << 1 / (om_ - 1.2);
+ auto gt = gf<imtime>{{beta, Fermion, 2 * n_iw + 1}, {2, 2}};
+ gt() = inverse_fourier(gw);
+
+ // Some threads transform, while another one keeps clearing the cache
+ std::atomic<int> n_running{4};
+ std::vector<gf<imtime>> res(4, gt);
+ std::vector<std::thread> threads;
+ for (int t = 0; t < 4; ++t)
+  threads.emplace_back([&, t] {
+   for (int i = 0; i < 50; ++i) res[t]() = inverse_fourier(gw);
+   --n_running;
+  });
+ while (n_running > 0) fftw::clear_plan_cache();
+ for (auto& th : threads) th.join();
+ for (auto const& r : res) EXPECT_GF_NEAR(gt, r);
+}
+MAKE_MAIN;
@@ -0,0 +1,60 @@
+#include "./poles.hpp"
+
+double beta = 2;
+poles_2x2 poles;
+
+gf<imfreq> make_gw(int n_iw) { return poles.make_gw(beta, Fermion, n_iw); }
+
+TEST(FourierMatrix, Analytic) {
+ int n_iw = 200;
+ auto gw = make_gw(n_iw);
+
+ auto gt = gf<imtime>{{beta, Fermion, 4 * n_iw + 1}, {2, 2}};
+ gt() = inverse_fourier(gw);
+ for (auto const& t : gt.mesh())
+  for (int i = 0; i < 2; ++i)
+   for (int j = 0; j < 2; ++j)
+    EXPECT_NEAR(std::abs(gt[t](i, j) - poles.gt_exact(beta, t, i, j)), 0, 1e-6);
+
+ auto gw2 = gf<imfreq>{{beta, Fermion, n_iw}, {2, 2}};
+ gw2() = fourier(gt);
+ EXPECT_ARRAY_NEAR(gw.data(), gw2.data(), 1e-6);
+}
+
+TEST(FourierMatrix, SameAsComponents) {
+ auto gw = make_gw(100);
+ auto gt = gf<imtime>{{beta, Fermion, 401}, {2, 2}};
+ gt() = inverse_fourier(gw);
+
+ for (int i = 0; i < 2; ++i)
+  for (int j = 0; j < 2; ++j) {
+   auto gt_ij = gf<imtime, scalar_valued>{gt.mesh()};
+   gt_ij() = inverse_fourier(slice_target_to_scalar(gw, i, j));
+   EXPECT_ARRAY_NEAR(gt_ij.data(), gt.data()(range(), i, j), 1e-12);
+
+   auto gw_ij = gf<imfreq, scalar_valued>{gw.mesh()};
+   gw_ij() = fourier(gt_ij);
+   auto gw2 = gf<imfreq>{gw.mesh(), {2, 2}};
+   gw2() = fourier(gt);
+   EXPECT_ARRAY_NEAR(gw_ij.data(), gw2.data()(range(), i, j), 1e-12);
+  }
+}
+
+TEST(FourierMatrix, StridedViews) {
+ // Transform a 2x2 sub-block of a 3x3 gf : non contiguous target
+ auto gw = make_gw(100);
+ auto gw3 = gf<imfreq>{gw.mesh(), {3, 3}};
+ gw3() = 0;
+ slice_target(gw3(), range(1, 3), range(0, 2)) = gw;
+
+ auto gt3 = gf<imtime>{{beta, Fermion, 401}, {3, 3}};
+ gt3() = 0;
+ slice_target(gt3(), range(1, 3), range(0, 2)) = inverse_fourier(slice_target(gw3(), range(1, 3), range(0, 2)));
+
+ auto gt = gf<imtime>{gt3.mesh(), {2, 2}};
+ gt() = inverse_fourier(gw);
+ EXPECT_ARRAY_NEAR(gt.data(), gt3.data()(range(), range(1, 3), range(0, 2)), 1e-12);
+ EXPECT_EQ(0, max_element(abs(gt3.data()(range(), 0, range()))));
+}
+
+MAKE_MAIN;
@@ -0,0 +1,38 @@
+#include "./poles.hpp"
+
+double beta = 3;
+
+// A real g(tau), from the poles of poles_2x2
+gf<imtime> make_gt(statistic_enum stat, int n_tau) {
+ auto gw = poles_2x2{}.make_gw(beta, stat, 100);
+ auto gt = gf<imtime>{{beta, stat, n_tau}, {2, 2}};
+ gt() = inverse_fourier(gw);
+ for (auto& x : gt.data()) x = x.real();
+ return gt;
+}
+
+// The real path (real FFTs) against the complex one, forced by a tiny imaginary part
+void check(statistic_enum stat, int n_tau) {
+ auto gt = make_gt(stat, n_tau);
+ auto gt_c = gt;
+ gt_c.data()(0, 0, 1) += 1_j * 1.e-10;
+
+ auto gw = gf<imfreq>{{beta, stat, 50}, {2, 2}};
+ gw() = fourier(gt);
+ auto gw_c = gw;
+ gw_c() = fourier(gt_c);
+ EXPECT_ARRAY_NEAR(gw_c.data(), gw.data(), 1.e-9);
+ EXPECT_TRUE(is_gf_real_in_tau(gw, 1.e-13));
+
+ // Only the positive frequencies
+ auto gw_pos = gf<imfreq>{{beta, stat, 50, matsubara_mesh_opt::positive_frequencies_only}, {2, 2}};
+ gw_pos() = fourier(gt);
+ EXPECT_ARRAY_NEAR(positive_freq_view(gw).data(), gw_pos.data(), 1.e-14);
+}
+
+TEST(FourierRealInTau, Fermion) { check(Fermion, 201); }
+TEST(FourierRealInTau, FermionOddL) { check(Fermion, 202); }
+TEST(FourierRealInTau, Boson) { check(Boson, 201); }
+TEST(FourierRealInTau, BosonOddL) { check(Boson, 202); }
+
+MAKE_MAIN;
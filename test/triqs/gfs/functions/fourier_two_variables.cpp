@@ -28,4 +28,57 @@ TEST(Fourier, TwoVariables){
  EXPECT_CLOSE_ARRAY(g2w.data(), g2w_2.data());
 }
 
+// The 2d transform against the 1d transforms of the slices, for a non trivial target
+TEST(Fourier, TwoVariablesSlices){
+ double beta = 2;
+ int n_iw=20, n_tau=2*n_iw+1;
+ auto f_imtime_mesh = gf_mesh<imtime>{beta, Fermion, n_tau};
+ auto b_imtime_mesh = gf_mesh<imtime>{beta, Boson, n_tau};
+
+ gf<cartesian_product<imtime, imtime>, tensor_valued<3>> g2t({f_imtime_mesh, b_imtime_mesh}, {2,1,2});
+ for (auto const & t : f_imtime_mesh)
+  for (auto const & tp : b_imtime_mesh)
+   for (int a = 0; a < 2; ++a)
+    for (int c = 0; c < 2; ++c) g2t[{t, tp}](a, 0, c) = exp(-(a + 1) * t) * cos(tp + c) + 1_j * a * t * tp;
+
+ auto g2w = fourier(g2t, n_iw, n_iw, false, true);
+
+ array<tail,3> tails(2,1,2);
+ tails() = tail(1,1);
+ auto gwt = gf<cartesian_product<imfreq, imtime>, tensor_valued<3>>({{beta, Fermion, n_iw}, b_imtime_mesh}, {2,1,2});
+ for (auto const & tp : b_imtime_mesh) {
+  auto g_t = gf<imtime, tensor_valued<3>, tail_zero<array<dcomplex,3>>>(f_imtime_mesh, {2,1,2});
+  for (auto const & t : f_imtime_mesh) g_t[t] = g2t[{t, tp}];
+  auto g_w = fourier(g_t, tails, n_iw, false);
+  for (auto const & w : g_w.mesh()) gwt[{w, tp}] = g_w[w];
+ }
+ for (auto const & w : std::get<0>(gwt.mesh().components())) {
+  auto g_t = gf<imtime, tensor_valued<3>, tail_zero<array<dcomplex,3>>>(b_imtime_mesh, {2,1,2});
+  for (auto const & tp : b_imtime_mesh) g_t[tp] = gwt[{w, tp}];
+  auto g_w = fourier(g_t, tails, n_iw, true);
+  for (auto const & nu : g_w.mesh()) EXPECT_ARRAY_NEAR(array<dcomplex,3>(g_w[nu]), array<dcomplex,3>(g2w[{w, nu}]), 1e-12);
+ }
+}
+
+// With the fit of the tails
+TEST(Fourier, TwoVariablesFitTails){
+ double beta = 1;
+ int n_iw=100, n_tau=4*n_iw+1;
+ auto f_imfreq_mesh = gf_mesh<imfreq>{beta, Fermion, n_iw};
+ auto b_imfreq_mesh = gf_mesh<imfreq>{beta, Boson, n_iw};
+
+ gf<cartesian_product<imfreq, imfreq>, tensor_valued<3>> g2w({f_imfreq_mesh, b_imfreq_mesh}, {1,1,1});
+ placeholder<0> om_;
+ placeholder<1> nu_;
+ g2w(om_,nu_) << 1/(om_ - 0.5) * 1/(nu_ + 2.);
+
+ auto g2t = inverse_fourier(g2w, n_tau, n_tau, true);
+ // exact : g(tau) g(tau') for the poles 0.5 (fermion) and -2 (boson)
+ for (auto const & t : std::get<0>(g2t.mesh().components()))
+  for (auto const & tp : std::get<1>(g2t.mesh().components())) {
+   double gt = -exp(-0.5 * t) / (1 + exp(-0.5 * beta)), gtp = exp(2 * tp) / (exp(2 * beta) - 1);
+   EXPECT_NEAR(std::abs(g2t[{t, tp}](0,0,0) - gt * gtp), 0, 1e-4);
+  }
+}
+
 MAKE_MAIN;
@@ -0,0 +1,63 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/gfs.hpp>
+
+using namespace triqs::gfs;
+using triqs::arrays::matrix;
+using triqs::arrays::range;
+
+double beta = 10;
+triqs::clef::placeholder<0> om_;
+
+gf<imfreq> make_g(double a) {
+ auto g = gf<imfreq>{{beta, Fermion, 100}, {2, 2}};
+ g(om_) << a / (om_ - 1.0);
+ return g;
+}
+
+// The elementwise expressions are evaluated on the whole data at once : compare with the mesh point by mesh point computation
+TEST(GfExpr, Elementwise) {
+ auto g1 = make_g(1), g2 = make_g(2), g3 = make_g(3);
+ auto g = gf<imfreq>{{beta, Fermion, 100}, {2, 2}};
+
+ g = 2 * g1 + g2 - g3 / 2.0;
+ for (auto const& w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(g[w]), matrix<dcomplex>(2.0 * g1[w] + g2[w] - g3[w] / 2.0), 1e-14);
+ EXPECT_ARRAY_NEAR(g.singularity().data(), (2 * g1.singularity() + g2.singularity() - g3.singularity() / 2.0).data());
+
+ // a view and aliasing
+ g() = -g + 1_j * g1;
+ for (auto const& w : g.mesh())
+  EXPECT_ARRAY_NEAR(matrix<dcomplex>(g[w]), matrix<dcomplex>(-(2.0 * g1[w] + g2[w] - g3[w] / 2.0) + 1_j * g1[w]), 1e-14);
+
+ // construction from an expression
+ gf<imfreq> g4 = g1 - g2;
+ EXPECT_ARRAY_NEAR(g4.data(), g1.data() - g2.data());
+
+ EXPECT_TRUE(gf_assign_data_elementwise(g.data(), 2 * g1 + g2 - g3 / 2.0));
+ EXPECT_FALSE(gf_assign_data_elementwise(g.data(), g1 * g2));
+
+ // a non contiguous target, not the fast path
+ auto s = slice_target(g, range(0, 1), range(0, 1));
+ EXPECT_FALSE(gf_assign_data_elementwise(s.data(), -slice_target(g1, range(0, 1), range(0, 1))));
+ s = slice_target(g1, range(0, 1), range(0, 1)) + slice_target(g2, range(0, 1), range(0, 1));
+ EXPECT_ARRAY_NEAR(s.data(), g1.data()(range(), range(0, 1), range(0, 1)) + g2.data()(range(), range(0, 1), range(0, 1)));
+}
+
+// Operations which are not elementwise for a matrix target
+TEST(GfExpr, NotElementwise) {
+ auto g1 = make_g(1), g2 = make_g(2);
+ auto g = gf<imfreq>{{beta, Fermion, 100}, {2, 2}};
+ g = 2.0 / g1;
+ for (auto const& w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(g[w]), matrix<dcomplex>(2.0 * inverse(matrix<dcomplex>(g1[w]))), 1e-12);
+ g = g1 * g2;
+ for (auto const& w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(g[w]), matrix<dcomplex>(g1[w] * g2[w]), 1e-14);
+}
+
+// For a scalar target, all operations are elementwise
+TEST(GfExpr, ScalarValued) {
+ auto g1 = gf<imfreq, scalar_valued>{{beta, Fermion, 100}};
+ g1(om_) << 1 / (om_ - 1.0);
+ auto g = g1;
+ g = g1 * g1 - 2 / g1;
+ for (auto const& w : g.mesh()) EXPECT_CLOSE(g[w], g1[w] * g1[w] - 2.0 / g1[w]);
+}
+MAKE_MAIN;
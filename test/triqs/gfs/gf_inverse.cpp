@@ -0,0 +1,45 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/gfs.hpp>
+
+using namespace triqs::gfs;
+using triqs::arrays::range;
+
+// A matrix valued gf with a non trivial, invertible value at each point
+gf<imfreq> make_g(int n) {
+ double beta = 10;
+ auto g = gf<imfreq>{{beta, Fermion, 100}, {n, n}};
+ triqs::clef::placeholder<0> om_;
+ auto m = triqs::arrays::matrix<double>(n, n);
+ for (int i = 0; i < n; ++i)
+  for (int j = 0; j < n; ++j) m(i, j) = (i == j ? 1.0 : 0.3 / (1 + i + j));
+ g(om_) << om_ + m;
+ return g;
+}
+
+TEST(Gf, InvertInPlace) {
+ for (int n = 1; n < 7; ++n) {
+  auto g = make_g(n);
+  auto g_inv = g;
+  invert_in_place(g_inv());
+  for (auto const& w : g.mesh()) {
+   triqs::arrays::matrix<dcomplex> m = g[w];
+   EXPECT_ARRAY_NEAR(triqs::arrays::matrix<dcomplex>(inverse(m)), g_inv[w], 1e-13);
+  }
+  EXPECT_GF_NEAR(g_inv, inverse(g));
+  // inverse twice (the tail order changes, compare the data only)
+  invert_in_place(g_inv());
+  EXPECT_ARRAY_NEAR(g.data(), g_inv.data(), 1e-12);
+ }
+}
+
+TEST(BlockGf, InvertInPlace) {
+ auto B = make_block_gf<imfreq>({"up", "dn"}, {make_g(2), make_g(5)});
+ auto B_inv = B;
+ invert_in_place(B_inv);
+ auto B_inv2 = inverse(B);
+ for (int b = 0; b < 2; ++b) {
+  EXPECT_GF_NEAR(inverse(B[b]), B_inv[b]);
+  EXPECT_GF_NEAR(B_inv2[b], B_inv[b]);
+ }
+}
+MAKE_MAIN;
@@ -0,0 +1,51 @@
+#include "./poles.hpp"
+
+double beta = 5;
+poles_2x2 poles;
+
+double g_exact(double tau, int i, int j) { return poles.gt_exact(beta, tau, i, j); }
+gf<imtime> make_gt(int n_tau) { return poles.make_gt(beta, n_tau); }
+
+TEST(ImtimeSpline, Accuracy) {
+ auto gt = make_gt(101);
+ auto gt_fine = make_gt(1001);
+ auto sp = make_imtime_spline(gt);
+ double err_spline = 0, err_linear_fine = 0;
+ for (int k = 0; k < 997; ++k) {
+  double tau = beta * (k + 0.5) / 997;
+  for (int i = 0; i < 2; ++i)
+   for (int j = 0; j < 2; ++j) {
+    err_spline = std::max(err_spline, std::abs(sp(tau, i, j) - g_exact(tau, i, j)));
+    err_linear_fine = std::max(err_linear_fine, std::abs(gt_fine(tau)(i, j) - g_exact(tau, i, j)));
+   }
+ }
+ // 10 times less points than the linear interpolation, for a better accuracy
+ EXPECT_LT(err_spline, 1.e-5);
+ EXPECT_LT(err_spline, err_linear_fine);
+
+ // exact on the mesh
+ for (auto const& t : gt.mesh()) EXPECT_CLOSE(gt[t](1, 0), sp(t, 1, 0));
+}
+
+TEST(ImtimeSpline, Antiperiodicity) {
+ auto gt = make_gt(51);
+ auto sp = make_imtime_spline(gt);
+ matrix<dcomplex> m1(2, 2), m2(2, 2);
+ for (double tau : {0.1, 1.3, 4.9}) {
+  EXPECT_CLOSE(sp(tau, 0, 1), -sp(tau - beta, 0, 1));
+  EXPECT_CLOSE(sp(tau, 0, 1), sp(tau + 2 * beta, 0, 1));
+  sp.evaluate(tau, m1);
+  sp.evaluate(tau + beta, m2);
+  EXPECT_ARRAY_NEAR(m1, -m2, 1.e-14);
+  EXPECT_CLOSE(m1(1, 1), sp(tau, 1, 1));
+ }
+
+ // bosons : periodic
+ auto gb = gf<imtime, scalar_real_valued>{{beta, Boson, 51}};
+ for (auto const& t : gb.mesh()) gb[t] = std::cosh(t - beta / 2);
+ auto spb = make_imtime_spline(gb);
+ EXPECT_NEAR(spb(1.3), spb(1.3 - beta), 1.e-14);
+ EXPECT_NEAR(spb(1.3), std::cosh(1.3 - beta / 2), 1.e-6);
+}
+
+MAKE_MAIN;
@@ -0,0 +1,37 @@
+#pragma once
+#include <triqs/test_tools/gfs.hpp>
+
+// A 2x2 gf with a different pole in each component : g_ij(i omega_n) = c_ij / (i omega_n - e_ij)
+struct poles_2x2 {
+ matrix<double> e{{1.0, -0.5}, {0.3, 2.0}}, c{{1.0, 0.2}, {-0.4, 0.7}};
+
+ // g(i omega_n) on n_iw frequencies, with its tail
+ gf<imfreq> make_gw(double beta, statistic_enum stat, int n_iw) const {
+  auto gw = gf<imfreq>{{beta, stat, n_iw}, {2, 2}};
+  for (auto const& w : gw.mesh())
+   for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j) gw[w](i, j) = c(i, j) / (dcomplex(w) - e(i, j));
+  auto& t = gw.singularity();
+  for (int i = 0; i < 2; ++i)
+   for (int j = 0; j < 2; ++j) {
+    t(1)(i, j) = c(i, j);
+    t(2)(i, j) = c(i, j) * e(i, j);
+    t(3)(i, j) = c(i, j) * e(i, j) * e(i, j);
+   }
+  return gw;
+ }
+
+ // The exact g_ij(tau) of fermions : - c_ij exp(-e_ij tau) / (1 + exp(-beta e_ij))
+ double gt_exact(double beta, double tau, int i, int j) const {
+  return -c(i, j) * std::exp(-e(i, j) * tau) / (1 + std::exp(-beta * e(i, j)));
+ }
+
+ // g(tau) of fermions on n_tau points, from the exact expression
+ gf<imtime> make_gt(double beta, int n_tau) const {
+  auto gt = gf<imtime>{{beta, Fermion, n_tau}, {2, 2}};
+  for (auto const& t : gt.mesh())
+   for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j) gt[t](i, j) = gt_exact(beta, t, i, j);
+  return gt;
+ }
+};
@@ -0,0 +1,44 @@
+#include "../dmft_archive.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+namespace h5 = triqs::h5;
+
+// Time to write a typical DMFT archive (cf dmft_archive.hpp) with various file access and write policies.
+// Usage : h5_archive_write_time [n_repeat]. The best time of the n_repeat writes is reported.
+int main(int argc, char* argv[]) {
+ int n_repeat = (argc > 1 ? std::atoi(argv[1]) : 5);
+ auto gs = make_dmft_archive_gs(); // computed once, out of the timings
+
+ h5::file_access_policy tuned;
+ tuned.latest_format = true;
+ tuned.metadata_cache_bytes = 16 << 20;
+ tuned.metadata_block_bytes = 1 << 16;
+ tuned.small_data_block_bytes = 1 << 16;
+ h5::write_policy compact;
+ compact.compact = true;
+ h5::file_access_policy in_memory = tuned;
+ in_memory.core_increment = 1 << 20;
+
+ struct config {
+  std::string name;
+  h5::file_access_policy fp;
+  h5::write_policy wp;
+ };
+ std::vector<config> configs = {
+     {"default", {}, {}}, {"tuned", tuned, {}}, {"tuned + compact", tuned, compact}, {"in memory + compact", in_memory, compact}};
+
+ for (auto const& c : configs) {
+  double best = 0;
+  for (int r = 0; r < n_repeat; ++r) {
+   auto t0 = std::chrono::steady_clock::now();
+   write_dmft_archive("archive_write_time.h5", c.fp, c.wp, gs);
+   double t = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+   if ((r == 0) || (t < best)) best = t;
+  }
+  std::cout << std::setw(22) << std::left << c.name << std::fixed << std::setprecision(2) << best << " ms" << std::endl;
+ }
+ std::remove("archive_write_time.h5");
+}
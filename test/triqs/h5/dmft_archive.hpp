@@ -0,0 +1,46 @@
+#pragma once
+#include <triqs/gfs.hpp>
+#include <string>
+#include <vector>
+
+// A typical DMFT archive : for each iteration, a few block Green functions and some parameters
+// i.e. many small groups, datasets and attributes
+const int dmft_archive_n_iter = 20, dmft_archive_n_bl = 4;
+const double dmft_archive_beta = 10;
+
+// The Green function of the iteration iter
+inline triqs::gfs::block_gf<triqs::gfs::imfreq> make_dmft_archive_g(int iter) {
+ using namespace triqs::gfs;
+ auto g = gf<imfreq>{{dmft_archive_beta, Fermion, 100}, {1, 1}};
+ for (auto const& w : g.mesh()) g[w] = 1 / (dcomplex(w) - 0.1 * iter);
+ return make_block_gf(dmft_archive_n_bl, g);
+}
+
+// The Green functions of all the iterations
+inline std::vector<triqs::gfs::block_gf<triqs::gfs::imfreq>> make_dmft_archive_gs() {
+ std::vector<triqs::gfs::block_gf<triqs::gfs::imfreq>> res;
+ for (int it = 0; it < dmft_archive_n_iter; ++it) res.push_back(make_dmft_archive_g(it));
+ return res;
+}
+
+// Write the archive, with the Green functions gs of the iterations
+inline void write_dmft_archive(std::string const& filename, triqs::h5::file_access_policy const& fp,
+                               triqs::h5::write_policy const& wp,
+                               std::vector<triqs::gfs::block_gf<triqs::gfs::imfreq>> const& gs) {
+ namespace h5 = triqs::h5;
+ h5::file f(filename, 'w', fp);
+ f.set_write_policy(wp);
+ h5::group top(f);
+ auto dmft = top.create_group("dmft");
+ for (int it = 0; it < dmft_archive_n_iter; ++it) {
+  auto gr = dmft.create_group("iteration_" + std::to_string(it));
+  auto const& g = gs[it];
+  h5_write(gr, "G_iw", g);
+  h5_write(gr, "Sigma_iw", g);
+  h5_write(gr, "G0_iw", g);
+  h5_write(gr, "mu", 0.1 * it);
+  h5_write(gr, "beta", dmft_archive_beta);
+  h5_write(gr, "n_cycles", long(1000 * it));
+  h5_write(gr, "solver", std::string("cthyb"));
+ }
+}
@@ -0,0 +1,65 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <hdf5.h>
+#include "./dmft_archive.hpp"
+namespace h5 = triqs::h5;
+
+void check_archive(std::string const& filename) {
+ h5::file f(filename, 'r');
+ auto gr = h5::group(f).open_group("dmft").open_group("iteration_7");
+ block_gf<imfreq> g;
+ h5_read(gr, "Sigma_iw", g);
+ EXPECT_BLOCK_GF_NEAR(make_dmft_archive_g(7), g);
+ double mu;
+ h5_read(gr, "mu", mu);
+ EXPECT_EQ(0.1 * 7, mu);
+ std::string s;
+ h5_read(gr, "solver", s);
+ EXPECT_EQ("cthyb", s);
+}
+
+// layout of the dataset name in the group g
+H5D_layout_t layout(h5::group g, std::string const& name) {
+ auto ds = g.open_dataset(name);
+ h5::proplist pl = H5Dget_create_plist(ds);
+ return H5Pget_layout(pl);
+}
+
+TEST(H5FileAccess, DMFTArchive) {
+ auto gs = make_dmft_archive_gs();
+ h5::file_access_policy tuned;
+ tuned.latest_format = true;
+ tuned.metadata_cache_bytes = 16 << 20;
+ tuned.metadata_block_bytes = 1 << 16;
+ tuned.small_data_block_bytes = 1 << 16;
+ h5::write_policy compact;
+ compact.compact = true;
+ h5::file_access_policy in_memory = tuned;
+ in_memory.core_increment = 1 << 20;
+
+ write_dmft_archive("archive_default.h5", {}, {}, gs);
+ write_dmft_archive("archive_tuned.h5", tuned, {}, gs);
+ write_dmft_archive("archive_tuned_compact.h5", tuned, compact, gs);
+ write_dmft_archive("archive_core_compact.h5", in_memory, compact, gs);
+
+ for (auto n : {"archive_default.h5", "archive_tuned.h5", "archive_tuned_compact.h5", "archive_core_compact.h5"}) check_archive(n);
+
+ h5::file f("archive_tuned_compact.h5", 'r');
+ auto gr = h5::group(f).open_group("dmft").open_group("iteration_3");
+ EXPECT_EQ(H5D_COMPACT, layout(gr, "mu"));
+ EXPECT_EQ(H5D_CONTIGUOUS, layout(gr.open_group("G_iw").open_group("0"), "data")); // 100 * 16 bytes
+}
+
+TEST(H5FileAccess, Alignment) {
+ h5::file_access_policy p;
+ p.alignment = 4096;
+ p.alignment_threshold = 1024;
+ {
+  h5::file f("aligned.h5", 'w', p);
+  h5_write(h5::group(f), "a", array<double, 1>(1000));
+ }
+ h5::file f("aligned.h5", 'r');
+ auto ds = h5::group(f).open_dataset("a");
+ EXPECT_EQ(0, H5Dget_offset(ds) % 4096);
+}
+
+MAKE_MAIN;
@@ -5,6 +5,7 @@
 #include <triqs/hilbert_space/hilbert_space.hpp>
 #include <triqs/hilbert_space/imperative_operator.hpp>
 #include <triqs/hilbert_space/state.hpp>
+#include <triqs/hilbert_space/adaptive_state.hpp>
 
 using namespace triqs::hilbert_space;
 
@@ -37,6 +38,41 @@ TEST(hilbert_space, fundamental_operator_set) {
  EXPECT_EQ(4, fop4.size());
 }
 
+TEST(hilbert_space, fundamental_operator_set_bulk) {
+ // Unsorted input with a duplicate
+ fundamental_operator_set::reduction_t v;
+ for (int i = 99; i >= 0; --i) v.push_back({"up", i});
+ for (int i = 0; i < 100; ++i) v.push_back({"dn", i});
+ v.push_back({"up", 3});
+ fundamental_operator_set fops(v);
+ EXPECT_EQ(200, fops.size());
+ EXPECT_EQ(0, (fops[{"dn", 0}]));
+ EXPECT_EQ(100, (fops[{"up", 0}]));
+ EXPECT_EQ(199, (fops[{"up", 99}]));
+ EXPECT_FALSE(fops.has_indices({"up", 100}));
+
+ // Same order as repeated insertions
+ fundamental_operator_set fops2;
+ for (auto const& ind : v) fops2.insert_from_indices_t(ind);
+ EXPECT_EQ(fundamental_operator_set::reduction_t(fops), fundamental_operator_set::reduction_t(fops2));
+ for (auto const& x : fops) EXPECT_EQ(x.linear_index, fops2[x.index]);
+
+ // Insertion in the middle shifts the following positions
+ fops2.insert("mid", 0);
+ EXPECT_EQ(100, (fops2[{"mid", 0}]));
+ EXPECT_EQ(101, (fops2[{"up", 0}]));
+ fops2.insert_range(v.begin(), v.end());
+ EXPECT_EQ(201, fops2.size());
+
+ // Copies and moves keep a valid lookup table
+ auto fops3 = fops2;
+ fops2 = fops;
+ EXPECT_EQ(101, (fops3[{"up", 0}]));
+ auto fops4 = std::move(fops3);
+ EXPECT_EQ(100, (fops4[{"mid", 0}]));
+ EXPECT_EQ(100, (fops2[{"up", 0}]));
+}
+
 TEST(hilbert_space, hilbert_space) {
  fundamental_operator_set fop(std::vector<int>(2,4));
 
@@ -208,4 +244,175 @@ TEST(hilbert_space, StateProjection) {
  EXPECT_EQ(" +(0.3)|4> +(0.4)|6>", as_string(proj_st)); // projected state
 }
 
+TEST(hilbert_space, Sectors) {
+ fundamental_operator_set fop;
+ for (int i=0; i<3; ++i) fop.insert("up",i);
+ for (int i=0; i<3; ++i) fop.insert("dn",i);
+
+ // 2 particles in 6 orbitals
+ auto sp2 = make_particle_number_sector(fop, 2, 3);
+ EXPECT_EQ(15, sp2.size());
+ EXPECT_EQ(3, sp2.get_index());
+ for (uint64_t i = 0; i < sp2.size(); ++i) {
+  EXPECT_EQ(2, count_number_of_bits(sp2.get_fock_state(i)));
+  if (i > 0) {
+   EXPECT_LT(sp2.get_fock_state(i - 1), sp2.get_fock_state(i));
+  }
+ }
+
+ // N_up = 1, N_dn = 2
+ std::vector<fundamental_operator_set::indices_t> up, dn;
+ for (int i=0; i<3; ++i) { up.push_back({"up",i}); dn.push_back({"dn",i}); }
+ auto sp12 = make_sector(fop, {{up, 1}, {dn, 2}});
+ EXPECT_EQ(9, sp12.size());
+ EXPECT_TRUE(sp12.has_state(triqs::hilbert_space::hilbert_space().get_fock_state(fop, {{"up", 1}, {"dn", 0}, {"dn", 2}})));
+
+ // Only the up orbitals are constrained
+ EXPECT_EQ(3 * 8, make_sector(fop, {{up, 1}}).size());
+}
+
+TEST(hilbert_space, ManyOrbitals) {
+ // 40 orbitals : the full space is never built
+ fundamental_operator_set fop;
+ for (int i=0; i<40; ++i) fop.insert(i);
+ auto sp = make_particle_number_sector(fop, 2);
+ EXPECT_EQ(40 * 39 / 2, sp.size());
+
+ using triqs::operators::c;
+ using triqs::operators::c_dag;
+ // Hopping between the far ends, across all the other orbitals
+ auto hop = c_dag(39) * c(0);
+ auto op = imperative_operator<sub_hilbert_space>(hop, fop);
+
+ state<sub_hilbert_space, double, true> st(sp);
+ fock_state_t f = (fock_state_t(1) << 0) + (fock_state_t(1) << 20);
+ st(sp.get_state_index(f)) = 1.0;
+ auto st2 = op(st);
+ // c^+_39 c_0 c^+_0 c^+_20 |0> = - c^+_20 c^+_39 |0>
+ EXPECT_EQ(-1.0, st2(sp.get_state_index((fock_state_t(1) << 20) + (fock_state_t(1) << 39))));
+}
+
+TEST(hilbert_space, SubspaceLookup) {
+ fundamental_operator_set fop;
+ for (int i=0; i<10; ++i) fop.insert(i);
+
+ auto check = [](sub_hilbert_space const& sp) {
+  for (uint64_t i = 0; i < sp.size(); ++i) {
+   EXPECT_TRUE(sp.has_state(sp.get_fock_state(i)));
+   EXPECT_EQ(i, sp.get_state_index(sp.get_fock_state(i)));
+  }
+ };
+
+ // Combinatorial ranking
+ auto sp = make_particle_number_sector(fop, 4);
+ EXPECT_EQ(210, sp.size());
+ check(sp);
+ EXPECT_FALSE(sp.has_state(7));
+ EXPECT_FALSE(sp.has_state(fock_state_t(15) << 10));
+
+ // Sorted states
+ sub_hilbert_space sp_sorted;
+ for (auto f : sp.get_all_fock_states()) sp_sorted.add_fock_state(f);
+ check(sp_sorted);
+ EXPECT_FALSE(sp_sorted.has_state(7));
+
+ // States in arbitrary order
+ sub_hilbert_space sp_map;
+ auto states = sp.get_all_fock_states();
+ std::reverse(states.begin(), states.end());
+ for (auto f : states) sp_map.add_fock_state(f);
+ check(sp_map);
+ EXPECT_FALSE(sp_map.has_state(7));
+
+ // Adding a state to a sector
+ sp.add_fock_state(fock_state_t(1) << 11);
+ check(sp);
+
+ // HDF5
+ EXPECT_EQ(sp_map, rw_h5(sp_map, "sub_hilbert_space"));
+ check(rw_h5(sp_map, "sub_hilbert_space"));
+ check(rw_h5(sp_sorted, "sub_hilbert_space"));
+}
+
+TEST(hilbert_space, AdaptiveState) {
+ fundamental_operator_set fop;
+ for (int i=0; i<4; ++i) fop.insert("up",i);
+
+ using triqs::hilbert_space::hilbert_space;
+ hilbert_space hs(fop);
+
+ using adaptive_t = adaptive_state<hilbert_space, double>;
+ adaptive_t st1(hs), st2(hs);
+ st1(3) = 1.0;
+ st1(0) = 2.0;
+ st2(5) = 3.0;
+ st2(3) = 4.0;
+ EXPECT_FALSE(st1.is_dense());
+ EXPECT_EQ(" +(2)|0> +(1)|3>", as_string(st1));
+ EXPECT_EQ(4.0, dot_product(st1, st2));
+
+ auto st3 = st1 + 2.0 * st2;
+ EXPECT_EQ(" +(2)|0> +(9)|3> +(6)|5>", as_string(st3));
+ EXPECT_FALSE(st3.is_dense());
+
+ // Above 1/4 of the 16 states : dense storage
+ st3(7) = 1.0;
+ st3(8) = 1.0;
+ EXPECT_TRUE(st3.is_dense());
+ EXPECT_EQ(" +(2)|0> +(9)|3> +(6)|5> +(1)|7> +(1)|8>", as_string(st3));
+ EXPECT_EQ(4.0 + 9.0, dot_product(st1, st3));
+ EXPECT_EQ(4.0 + 9.0, dot_product(st3, st1));
+ EXPECT_EQ(4.0 + 81.0 + 36.0 + 2.0, dot_product(st3, st3));
+
+ axpy(-1.0, st3, st3);
+ EXPECT_EQ("0", as_string(st3));
+ st3.prune();
+ EXPECT_FALSE(st3.is_dense());
+
+ // Act with an operator
+ using triqs::operators::c;
+ using triqs::operators::c_dag;
+ auto H = 3 * c_dag("up",1) * c("up",1) + c_dag("up",2) * c("up",0);
+ auto opH = imperative_operator<hilbert_space>(H, fop);
+ EXPECT_EQ(" +(3)|3> +(-1)|6>", as_string(opH(st1)));
+
+ // Same result as the other implementations
+ state<hilbert_space, double, false> st_dense(hs);
+ st_dense(3) = 1.0;
+ st_dense(0) = 2.0;
+ EXPECT_EQ(as_string(opH(st_dense)), as_string(project<state<hilbert_space, double, false>>(opH(st1), hs)));
+}
+
+TEST(hilbert_space, AdaptiveStateFill) {
+ // 20 orbitals, 2^20 states : filled in random order with repeated indices, as by imperative_operator
+ fundamental_operator_set fop;
+ for (int i = 0; i < 20; ++i) fop.insert("up", i);
+ using triqs::hilbert_space::hilbert_space;
+ hilbert_space hs(fop);
+ adaptive_state<hilbert_space, double> st(hs);
+ std::map<uint64_t, double> ref;
+ uint64_t x = 1;
+ for (int n = 0; n < 200000; ++n) {
+  x = (x * 6364136223846793005ull + 1442695040888963407ull);
+  uint64_t i = (x >> 33) % 150000 * 5; // 150000 distinct indices, below 1/4 of the dimension
+  st(i) += 1.0;
+  ref[i] += 1.0;
+ }
+ EXPECT_FALSE(st.is_dense());
+ auto const& cst = st;
+ for (auto const& r : ref) EXPECT_EQ(r.second, cst(r.first));
+ EXPECT_EQ(0.0, cst(1));
+ using visited_t = std::vector<std::pair<uint64_t, double>>;
+ visited_t visited, expected(ref.begin(), ref.end());
+ foreach(st, [&visited](uint64_t i, double v) { visited.emplace_back(i, v); });
+ EXPECT_TRUE(visited == expected); // in increasing order
+ double norm2 = 0;
+ for (auto const& r : ref) norm2 += r.second * r.second;
+ EXPECT_EQ(norm2, dot_product(st, st));
+ auto st2 = st;
+ axpy(-1.0, st, st2);
+ st2.prune();
+ EXPECT_EQ("0", as_string(st2));
+}
+
 MAKE_MAIN;
@@ -0,0 +1,31 @@
+#pragma once
+#include <triqs/operators/many_body_operator.hpp>
+#include <triqs/hilbert_space/fundamental_operator_set.hpp>
+
+// Fundamental operators ("up", o) and ("dn", o) of n_orb orbitals
+inline triqs::hilbert_space::fundamental_operator_set make_kanamori_fops(int n_orb) {
+ triqs::hilbert_space::fundamental_operator_set fops;
+ for (int o = 0; o < n_orb; ++o) {
+  fops.insert("up", o);
+  fops.insert("dn", o);
+ }
+ return fops;
+}
+
+// Kanamori Hamiltonian of n_orb orbitals, with chemical potential mu
+inline triqs::operators::many_body_operator make_kanamori_hamiltonian(int n_orb, double U, double J, double mu) {
+ using triqs::operators::c;
+ using triqs::operators::c_dag;
+ using triqs::operators::n;
+ triqs::operators::many_body_operator H;
+ for (int o = 0; o < n_orb; ++o) H += -mu * (n("up", o) + n("dn", o)) + U * n("up", o) * n("dn", o);
+ for (int o1 = 0; o1 < n_orb; ++o1)
+  for (int o2 = 0; o2 < n_orb; ++o2) {
+   if (o1 == o2) continue;
+   H += (U - 2 * J) * n("up", o1) * n("dn", o2);
+   if (o2 < o1) H += (U - 3 * J) * (n("up", o1) * n("up", o2) + n("dn", o1) * n("dn", o2));
+   H += -J * c_dag("up", o1) * c_dag("dn", o1) * c("up", o2) * c("dn", o2);
+   H += -J * c_dag("up", o1) * c_dag("dn", o2) * c("up", o2) * c("dn", o1);
+  }
+ return H;
+}
@@ -0,0 +1,153 @@
+#include <triqs/test_tools/arrays.hpp>
+
+#include <triqs/operators/many_body_operator.hpp>
+#include <triqs/hilbert_space/krylov.hpp>
+#include <triqs/hilbert_space/state.hpp>
+#include <triqs/arrays/linalg/eigenelements.hpp>
+#include "./kanamori.hpp"
+
+using namespace triqs::hilbert_space;
+using triqs::operators::many_body_operator;
+using triqs::operators::c;
+using triqs::operators::c_dag;
+using triqs::operators::n;
+using triqs::arrays::matrix;
+using triqs::arrays::range;
+using vector_t = triqs::arrays::vector<double>;
+
+// 3 bands Kanamori
+int n_orb = 3;
+fundamental_operator_set make_fops() { return make_kanamori_fops(n_orb); }
+many_body_operator make_hamiltonian() { return make_kanamori_hamiltonian(n_orb, 3.0, 0.3, 0.7); }
+
+// Blocks of H in the invariant subspaces found by the automatic partition
+std::vector<csr_matrix<double>> make_blocks(many_body_operator const& H, fundamental_operator_set const& fops) {
+ hilbert_space hs(fops);
+ state<hilbert_space, double, true> st(hs);
+ using op_t = imperative_operator<hilbert_space, double, false>;
+ op_t opH(H, fops);
+ space_partition<state<hilbert_space, double, true>, op_t> SP(st, opH, false);
+ std::vector<csr_matrix<double>> blocks;
+ for (auto const& sp : make_sub_hilbert_spaces(SP, hs)) blocks.push_back(make_csr_matrix(H, fops, sp));
+ return blocks;
+}
+
+TEST(krylov, LowestEigenstates) {
+ auto fops = make_fops();
+ auto blocks = make_blocks(make_hamiltonian(), fops);
+ uint64_t total_dim = 0;
+ for (auto const& b : blocks) total_dim += b.n_rows;
+ EXPECT_EQ(64, total_dim);
+
+ auto eig = lowest_eigenstates(blocks, 2);
+ for (int b = 0; b < blocks.size(); ++b) {
+  auto ref = triqs::arrays::linalg::eigenvalues(blocks[b].to_dense());
+  int n = std::min<int>(2, blocks[b].n_rows);
+  ASSERT_EQ(n, eig[b].eigenvalues.size());
+  // The lowest eigenvalue is always found, the next one up to degeneracies
+  EXPECT_NEAR(ref(0), eig[b].eigenvalues[0], 1e-10);
+  for (int k = 0; k < n; ++k) {
+   vector_t v = eig[b].eigenvectors[k], hv(v.size());
+   blocks[b].apply(v, hv);
+   EXPECT_ARRAY_NEAR(vector_t(eig[b].eigenvalues[k] * v), hv, 1e-8);
+  }
+ }
+}
+
+TEST(krylov, Restart) {
+ // A single large block with a tiny Krylov basis
+ auto fops = make_fops();
+ auto H = make_hamiltonian();
+ auto m = make_csr_matrix(H, fops, make_particle_number_sector(fops, 3));
+ auto ref = triqs::arrays::linalg::eigenvalues(m.to_dense());
+ auto eig = krylov_solver<double>(m, 8).lowest_eigenstates(1);
+ EXPECT_NEAR(ref(0), eig.eigenvalues[0], 1e-10);
+}
+
+TEST(krylov, ExpMinusTauH) {
+ auto fops = make_fops();
+ auto H = make_hamiltonian();
+ auto m = make_csr_matrix(H, fops, make_particle_number_sector(fops, 3));
+ auto dense = m.to_dense();
+ auto es = triqs::arrays::linalg::eigenelements(dense);
+
+ vector_t psi(m.n_rows);
+ for (int i = 0; i < psi.size(); ++i) psi(i) = std::cos(i);
+
+ for (double tau : {0.1, 1.0, 5.0}) {
+  // Reference from the exact diagonalization: the eigenvectors are the rows of es.second
+  vector_t ref(psi.size());
+  ref() = 0;
+  for (int l = 0; l < psi.size(); ++l) {
+   vector_t e = es.second(l, range());
+   ref += std::exp(-tau * es.first(l)) * triqs::arrays::dotc(e, psi) * e;
+  }
+  for (int max_dim : {100, 6}) {
+   krylov_solver<double> solver(m, max_dim, 1e-12);
+   auto res = solver.exp_minus_tau_h(tau, psi);
+   EXPECT_ARRAY_NEAR(ref, res, 1e-8 * std::exp(-tau * es.first(0)));
+  }
+ }
+ EXPECT_THROW(krylov_solver<double>(m).exp_minus_tau_h(-1.0, psi), triqs::runtime_error);
+
+ // Propagation of the blocks in parallel
+ auto blocks = make_blocks(H, fops);
+ std::vector<vector_t> psis;
+ for (auto const& b : blocks) {
+  vector_t v(b.n_rows);
+  v() = 1;
+  psis.push_back(v);
+ }
+ auto psis0 = psis;
+ exp_minus_tau_h_in_place(blocks, 0.5, psis);
+ for (int b = 0; b < blocks.size(); ++b)
+  EXPECT_ARRAY_NEAR(krylov_solver<double>(blocks[b]).exp_minus_tau_h(0.5, psis0[b]), psis[b], 1e-10);
+}
+TEST(krylov, ComplexHopping) {
+ using dcomplex = std::complex<double>;
+ using cvector_t = triqs::arrays::vector<dcomplex>;
+ auto fops = make_fops();
+ auto H = make_hamiltonian();
+ dcomplex t(0.3, 0.4);
+ for (auto s : {"up", "dn"})
+  for (int o = 0; o < n_orb; ++o) {
+   auto hop = t * c_dag(s, o) * c(s, (o + 1) % n_orb);
+   H += hop + dagger(hop);
+  }
+ auto m = make_csr_matrix<dcomplex>(H, fops, make_particle_number_sector(fops, 3));
+ auto dense = m.to_dense();
+ auto es = triqs::arrays::linalg::eigenelements(dense);
+
+ // Dense diagonalization : the eigenvectors are the rows of es.second
+ for (int l = 0; l < m.n_rows; ++l) {
+  cvector_t e = es.second(l, range()), he = dense * e;
+  EXPECT_ARRAY_NEAR(cvector_t(es.first(l) * e), he, 1e-10);
+ }
+
+ // Lowest eigenstates
+ auto eig = krylov_solver<dcomplex>(m).lowest_eigenstates(2);
+ ASSERT_EQ(2, eig.eigenvalues.size());
+ EXPECT_NEAR(es.first(0), eig.eigenvalues[0], 1e-10);
+ for (int k = 0; k < 2; ++k) {
+  cvector_t v = eig.eigenvectors[k], hv(v.size());
+  m.apply(v, hv);
+  EXPECT_ARRAY_NEAR(cvector_t(eig.eigenvalues[k] * v), hv, 1e-8);
+ }
+
+ // exp(-tau H) psi, against the dense exponential
+ cvector_t psi(m.n_rows);
+ for (int i = 0; i < psi.size(); ++i) psi(i) = dcomplex(std::cos(i), std::sin(2 * i));
+ for (double tau : {0.1, 1.0, 5.0}) {
+  matrix<dcomplex> expm(m.n_rows, m.n_rows);
+  expm() = 0;
+  for (int l = 0; l < m.n_rows; ++l)
+   for (int i = 0; i < m.n_rows; ++i)
+    for (int j = 0; j < m.n_rows; ++j) expm(i, j) += std::exp(-tau * es.first(l)) * es.second(l, i) * std::conj(es.second(l, j));
+  cvector_t ref = expm * psi;
+  for (int max_dim : {100, 6}) {
+   auto res = krylov_solver<dcomplex>(m, max_dim, 1e-12).exp_minus_tau_h(tau, psi);
+   EXPECT_ARRAY_NEAR(ref, res, 1e-8 * std::exp(-tau * es.first(0)));
+  }
+ }
+}
+MAKE_MAIN;
@@ -350,3 +350,69 @@ TEST(space_partition, Phase2) {
 
 }
 
+
+// Check connections found by find_mappings
+TEST(space_partition, Mappings) {
+
+ // Hilbert space
+ hilbert_space hs(fops);
+
+ // Sample state
+ state_t st(hs);
+
+ // Imperative operator for H
+ imp_op_t Hop(H, fops);
+
+ // Space partition
+ space_partition<state_t,imp_op_t> SP(st, Hop);
+
+ // H is block-diagonal, and vanishes on the vacuum
+ auto H_conn = SP.find_mappings(Hop);
+ EXPECT_EQ(SP.n_subspaces() - 1, H_conn.size());
+ for (auto const& c : H_conn) EXPECT_EQ(c.first, c.second);
+
+ // C^+ : from every subspace but the full one
+ auto Cd_conn = SP.find_mappings(imp_op_t(c_dag("up", 0), fops));
+ std::set<int> from, to;
+ for (auto const& c : Cd_conn) {
+  from.insert(c.first);
+  to.insert(c.second);
+  EXPECT_NE(c.first, c.second);
+ }
+ EXPECT_EQ(0, from.count(SP.lookup_basis_state(hs.size() - 1)));
+ EXPECT_EQ(1, from.count(SP.lookup_basis_state(0)));
+ EXPECT_EQ(0, to.count(SP.lookup_basis_state(0)));
+
+ // Only the diagonal connections
+ EXPECT_TRUE(SP.find_mappings(imp_op_t(c_dag("up", 0), fops), true).empty());
+}
+
+// Phase I without the matrix elements
+TEST(space_partition, NoMatrixElements) {
+ hilbert_space hs(fops);
+ state_t st(hs);
+ imp_op_t Hop(H, fops);
+ space_partition<state_t, imp_op_t> SP(st, Hop), SP_no_elements(st, Hop, false);
+
+ EXPECT_TRUE(SP_no_elements.get_matrix_elements().empty());
+ EXPECT_EQ(SP.n_subspaces(), SP_no_elements.n_subspaces());
+ for (int n = 0; n < hs.size(); ++n) EXPECT_EQ(SP.lookup_basis_state(n), SP_no_elements.lookup_basis_state(n));
+}
+
+// An operator failing on one basis state
+struct throwing_op_t {
+ imp_op_t op;
+ state_t operator()(state_t const& st) const {
+  auto s = st;
+  if (s(37) == 1.0) TRIQS_RUNTIME_ERROR << "throwing_op_t";
+  return op(st);
+ }
+};
+
+// The exception is rethrown out of the parallel loop
+TEST(space_partition, Exception) {
+ hilbert_space hs(fops);
+ state_t st(hs);
+ throwing_op_t Hop{imp_op_t(H, fops)};
+ EXPECT_THROW((space_partition<state_t, throwing_op_t>(st, Hop)), triqs::runtime_error);
+}
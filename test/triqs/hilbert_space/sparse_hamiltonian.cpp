@@ -0,0 +1,124 @@
+#include <triqs/test_tools/arrays.hpp>
+
+#include <triqs/operators/many_body_operator.hpp>
+#include <triqs/hilbert_space/sparse_hamiltonian.hpp>
+#include <triqs/hilbert_space/state.hpp>
+#include "./kanamori.hpp"
+
+using namespace triqs::hilbert_space;
+using triqs::operators::many_body_operator;
+using triqs::operators::c;
+using triqs::operators::c_dag;
+using triqs::operators::n;
+using triqs::arrays::matrix;
+
+using dcomplex = std::complex<double>;
+
+// Reference matrix, from the action of imperative_operator on the basis states: m(j, i) = <j|H|i>
+template <typename ScalarType = double>
+matrix<ScalarType> reference_matrix(many_body_operator const& H, fundamental_operator_set const& fops, sub_hilbert_space const& sp) {
+ imperative_operator<sub_hilbert_space, ScalarType> opH(H, fops);
+ matrix<ScalarType> m(sp.size(), sp.size());
+ for (int i = 0; i < sp.size(); ++i) {
+  state<sub_hilbert_space, ScalarType, false> st(sp);
+  st(i) = 1;
+  auto res = opH(st);
+  for (int j = 0; j < sp.size(); ++j) m(j, i) = res(j);
+ }
+ return m;
+}
+
+TEST(sparse_hamiltonian, NSz) {
+ int n_orb = 3;
+ auto fops = make_kanamori_fops(n_orb);
+ std::vector<fundamental_operator_set::indices_t> up, dn;
+ for (int o = 0; o < n_orb; ++o) {
+  up.push_back({"up", o});
+  dn.push_back({"dn", o});
+ }
+ auto H = make_kanamori_hamiltonian(n_orb, 3.0, 0.3, 0.7);
+
+ auto sectors = make_sector_hamiltonians(H, fops, {up, dn});
+ EXPECT_EQ((n_orb + 1) * (n_orb + 1), sectors.size());
+ uint64_t total_dim = 0;
+ for (auto const& s : sectors) {
+  total_dim += s.space.size();
+  EXPECT_EQ(s.space.size(), s.matrix.n_rows);
+  EXPECT_ARRAY_NEAR(reference_matrix(H, fops, s.space), s.matrix.to_dense());
+ }
+ EXPECT_EQ(1 << (2 * n_orb), total_dim);
+
+ // N_up = 2, N_dn = 1
+ auto const& s = sectors[2 * (n_orb + 1) + 1];
+ EXPECT_EQ((std::vector<int>{2, 1}), s.occupations);
+ EXPECT_EQ(9, s.space.size());
+
+ // Matrix-vector product
+ triqs::arrays::vector<double> x(s.space.size()), y(s.space.size());
+ for (int i = 0; i < x.size(); ++i) x(i) = i + 1;
+ s.matrix.apply(x, y);
+ EXPECT_ARRAY_NEAR(s.matrix.to_dense() * x, y);
+
+ // HDF5
+ auto s2 = rw_h5(s, "sparse_hamiltonian");
+ EXPECT_EQ(s.occupations, s2.occupations);
+ EXPECT_EQ(s.space, s2.space);
+ EXPECT_EQ(s.matrix.row_ptr, s2.matrix.row_ptr);
+ EXPECT_EQ(s.matrix.col_index, s2.matrix.col_index);
+ EXPECT_ARRAY_NEAR(s.matrix.values, s2.matrix.values);
+}
+
+TEST(sparse_hamiltonian, N) {
+ auto fops = make_kanamori_fops(2);
+ auto H = make_kanamori_hamiltonian(2, 2.0, 0.2, 1.0);
+ auto sectors = make_sector_hamiltonians(H, fops);
+ EXPECT_EQ(5, sectors.size());
+ for (auto const& s : sectors) EXPECT_ARRAY_NEAR(reference_matrix(H, fops, s.space), s.matrix.to_dense());
+
+ // Operator which does not conserve the occupations
+ EXPECT_THROW(make_sector_hamiltonians(H + c("up", 0), fops), triqs::runtime_error);
+ EXPECT_THROW(make_sector_hamiltonians(H + c_dag("up", 0) * c("dn", 0), fops, {{{"up", 0}, {"up", 1}}}),
+              triqs::runtime_error);
+}
+TEST(sparse_hamiltonian, NonSymmetric) {
+ auto fops = make_kanamori_fops(2);
+ auto sp = make_particle_number_sector(fops, 1);
+ auto m = make_csr_matrix(c_dag("up", 0) * c("up", 1), fops, sp);
+ auto index = [&](const char* s, int o) { return sp.get_state_index(fock_state_t(1) << fops[{s, o}]); };
+
+ // c_dag(0) c(1) |1> = |0>: a single element, in row |0> and column |1>
+ ASSERT_EQ(1, m.nnz());
+ auto dense = m.to_dense();
+ EXPECT_EQ(1.0, dense(index("up", 0), index("up", 1)));
+ EXPECT_EQ(0.0, dense(index("up", 1), index("up", 0)));
+
+ // A non-symmetric operator with several elements per row
+ auto sp2 = make_particle_number_sector(fops, 2);
+ auto A = c_dag("up", 0) * c("up", 1) + 2 * c_dag("dn", 1) * c("up", 0) + 0.5 * c_dag("up", 0) * c_dag("dn", 0) * c("dn", 1) * c("up", 1);
+ auto mA = make_csr_matrix(A, fops, sp2);
+ EXPECT_ARRAY_NEAR(reference_matrix(A, fops, sp2), mA.to_dense());
+
+ // y = A x, checked against the action of the operator on a state
+ triqs::arrays::vector<double> x(sp2.size()), y(sp2.size());
+ for (int i = 0; i < x.size(); ++i) x(i) = i + 1;
+ mA.apply(x, y);
+ state<sub_hilbert_space, double, false> st(sp2);
+ for (int i = 0; i < x.size(); ++i) st(i) = x(i);
+ auto ref = imperative_operator<sub_hilbert_space>(A, fops)(st);
+ for (int i = 0; i < x.size(); ++i) EXPECT_NEAR(ref(i), y(i), 1e-14);
+}
+
+TEST(sparse_hamiltonian, ComplexHermitian) {
+ auto fops = make_kanamori_fops(2);
+ dcomplex t(0.3, 0.4);
+ auto H = make_kanamori_hamiltonian(2, 2.0, 0.2, 1.0);
+ for (auto s : {"up", "dn"}) H += t * c_dag(s, 0) * c(s, 1) + std::conj(t) * c_dag(s, 1) * c(s, 0);
+
+ for (auto const& s : make_sector_hamiltonians<dcomplex>(H, fops)) {
+  auto dense = s.matrix.to_dense();
+  EXPECT_ARRAY_NEAR(reference_matrix<dcomplex>(H, fops, s.space), dense);
+  matrix<dcomplex> h_dag = triqs::arrays::conj(triqs::arrays::transpose(dense));
+  EXPECT_ARRAY_NEAR(h_dag, dense);
+ }
+}
+MAKE_MAIN;
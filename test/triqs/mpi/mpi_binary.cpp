@@ -0,0 +1,30 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/operators/many_body_operator.hpp>
+#include <triqs/utility/binary_archive.hpp>
+
+using namespace triqs;
+using namespace triqs::operators;
+
+TEST(MpiBinary, Broadcast) {
+ mpi::communicator world;
+
+ many_body_operator h;
+ std::map<std::string, std::vector<double>> params;
+ auto g = gf<imfreq>{{10, Fermion, 20}, {2, 2}};
+ if (world.rank() == 0) {
+  h = n("up", 0) * n("dn", 0) + 0.5 * c_dag("up", 0) * c("dn", 0);
+  params["eps"] = {-1, 0, 1};
+  clef::placeholder<0> w_;
+  g(w_) << 1 / (w_ + 1.5);
+ }
+ mpi::mpi_broadcast_binary(h, world);
+ mpi::mpi_broadcast_binary(params, world);
+ mpi::mpi_broadcast_binary(g, world);
+
+ auto h_ref = n("up", 0) * n("dn", 0) + 0.5 * c_dag("up", 0) * c("dn", 0);
+ EXPECT_TRUE((h - h_ref).is_zero());
+ EXPECT_EQ(params["eps"], (std::vector<double>{-1, 0, 1}));
+ EXPECT_EQ(g[0](1, 1), 1 / (dcomplex(0, M_PI / 10) + 1.5));
+}
+
+MAKE_MAIN;
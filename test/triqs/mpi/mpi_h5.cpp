@@ -0,0 +1,118 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/h5/base.hpp> // H5_HAVE_PARALLEL
+
+using namespace triqs;
+namespace h5 = triqs::h5;
+
+TEST(MpiH5, Array) {
+ mpi::communicator world;
+ array<dcomplex, 3> A(11, 2, 3);
+ for (int i = 0; i < 11; ++i)
+  for (int j = 0; j < 2; ++j)
+   for (int k = 0; k < 3; ++k) A(i, j, k) = dcomplex(i + 10 * j, k);
+ array<dcomplex, 3> B = mpi_scatter(A, world);
+ {
+  h5::file f("mpi_h5_array.h5", 'w', world);
+  h5_write_distributed(h5::group(f), "A", B, world);
+  // a strided view, and an empty slice on some nodes when there are more nodes than rows
+  array<double, 2> D(2 * world.size() - 1, 4);
+  for (int i = 0; i < first_dim(D); ++i)
+   for (int j = 0; j < 4; ++j) D(i, j) = i - j;
+  array<double, 2> E = mpi_scatter(D, world);
+  h5_write_distributed(h5::group(f), "D", E(range(), range(0, 4, 2)), world);
+  if (world.rank() == 0) D = array<double, 2>(D(range(), range(0, 4, 2)));
+  world.barrier();
+  if (world.rank() == 0) {
+   h5::file f2("mpi_h5_array.h5", 'r');
+   array<double, 2> D2;
+   h5_read(h5::group(f2), "D", D2);
+   EXPECT_ARRAY_EQ(D2, D);
+  }
+ }
+ if (world.rank() == 0) {
+  h5::file f("mpi_h5_array.h5", 'r');
+  array<dcomplex, 3> A2;
+  h5_read(h5::group(f), "A", A2);
+  EXPECT_ARRAY_EQ(A2, A);
+ }
+ // the nodes disagree on the shape
+ array<dcomplex, 3> W(first_dim(B), 3, 3);
+ if (world.size() > 1) EXPECT_THROW(h5_write_distributed(h5::group{}, "W", (world.rank() == 0 ? W : B), world), triqs::runtime_error);
+}
+
+// The array of the tests, and its rows on this node
+array<double, 2> make_rows(mpi::communicator c) {
+ array<double, 2> A(3 * c.size() + 1, 5);
+ for (int i = 0; i < first_dim(A); ++i)
+  for (int j = 0; j < 5; ++j) A(i, j) = 10 * i + j;
+ return A;
+}
+
+// Serial HDF5, whatever the library : the root writes all the slices, the other nodes pass an empty group
+TEST(MpiH5, SerialFallback) {
+ mpi::communicator world;
+ auto A = make_rows(world);
+ array<double, 2> B = mpi_scatter(A, world);
+ {
+  h5::group g;
+  if (world.rank() == 0) g = h5::group(h5::file("mpi_h5_serial.h5", 'w'));
+  EXPECT_FALSE(g.is_parallel());
+  h5_write_distributed(g, "A", B, world);
+ }
+ if (world.rank() == 0) {
+  h5::file f("mpi_h5_serial.h5", 'r');
+  array<double, 2> A2;
+  h5_read(h5::group(f), "A", A2);
+  EXPECT_ARRAY_EQ(A2, A);
+ }
+}
+
+// Parallel HDF5 : the file is opened with MPI-IO on every node, each node writes its own hyperslab
+TEST(MpiH5, ParallelWrite) {
+#ifdef H5_HAVE_PARALLEL
+ mpi::communicator world;
+ auto A = make_rows(world);
+ array<double, 2> B = mpi_scatter(A, world);
+ {
+  h5::file f("mpi_h5_parallel.h5", 'w', world);
+  EXPECT_TRUE(f.is_parallel());
+  h5::group g(f);
+  EXPECT_TRUE(g.is_valid());
+  EXPECT_TRUE(g.is_parallel());
+  h5_write_distributed(g, "A", B, world);
+  array<double, 2> B2 = B;
+  B2 *= 2;
+  h5_write_distributed(g, "A2", B2, world);
+ }
+ // read back on every node, with MPI-IO
+ {
+  h5::file f("mpi_h5_parallel.h5", 'r', world);
+  array<double, 2> A2, A3;
+  h5_read(h5::group(f), "A", A2);
+  EXPECT_ARRAY_EQ(A2, A);
+  h5_read(h5::group(f), "A2", A3);
+  array<double, 2> A_times_2 = 2 * A;
+  EXPECT_ARRAY_EQ(A3, A_times_2);
+ }
+#endif
+}
+
+TEST(MpiH5, Gf) {
+ mpi::communicator world;
+ clef::placeholder<0> w_;
+ auto g = gf<imfreq>{{10, Fermion, 20}, {2, 2}};
+ g(w_) << 1 / (w_ + 1.5);
+ gf<imfreq> gl = mpi_scatter(g, world);
+ {
+  h5::file f("mpi_h5_gf.h5", 'w', world);
+  h5_write_distributed(h5::group(f), "g", gl, world);
+ }
+ if (world.rank() == 0) {
+  h5::file f("mpi_h5_gf.h5", 'r');
+  gf<imfreq> g2;
+  h5_read(h5::group(f), "g", g2);
+  EXPECT_GF_NEAR(g2, g);
+ }
+}
+
+MAKE_MAIN;
@@ -0,0 +1,91 @@
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/operators/many_body_operator.hpp>
+
+using namespace triqs::operators;
+using triqs::utility::is_zero;
+
+// The product of the monomials of a and b, normalized as in the original std::map based implementation
+template <typename S> std::map<monomial_t, S> reference_product(many_body_operator_generic<S> const& a, many_body_operator_generic<S> const& b) {
+ std::map<monomial_t, S> res;
+ std::function<void(monomial_t&, S)> normalize_and_insert = [&](monomial_t& m, S coeff) {
+  bool is_swapped;
+  do {
+   is_swapped = false;
+   for (std::size_t n = 1; n < m.size(); ++n) {
+    if (m[n - 1] == m[n]) return;
+    if (m[n - 1] > m[n]) {
+     if ((m[n - 1].dagger != m[n].dagger) && (m[n - 1].indices == m[n].indices)) {
+      monomial_t new_m(m.begin(), m.begin() + n - 1);
+      new_m.insert(new_m.end(), m.begin() + n + 1, m.end());
+      normalize_and_insert(new_m, coeff);
+     }
+     coeff = -coeff;
+     std::swap(m[n - 1], m[n]);
+     is_swapped = true;
+    }
+   }
+  } while (is_swapped);
+  res[m] += coeff;
+ };
+ for (auto const& x : a.get_monomials())
+  for (auto const& y : b.get_monomials()) {
+   monomial_t m = x.first;
+   m.insert(m.end(), y.first.begin(), y.first.end());
+   normalize_and_insert(m, x.second * y.second);
+  }
+ for (auto it = res.begin(); it != res.end();) it = (is_zero(it->second) ? res.erase(it) : std::next(it));
+ return res;
+}
+
+template <typename S> void check_product(many_body_operator_generic<S> const& a, many_body_operator_generic<S> const& b) {
+ auto ref = reference_product(a, b);
+ auto ab = a * b;
+ auto const& p = ab.get_monomials();
+ ASSERT_EQ(ref.size(), p.size());
+ auto it = p.begin();
+ for (auto const& x : ref) { // same monomials, in the same order
+  EXPECT_TRUE(x.first == it->first);
+  EXPECT_NEAR(0, std::abs(x.second - it->second), 1.e-12);
+  ++it;
+ }
+}
+
+// Multi-term operators, with several kinds of indices
+template <typename S> std::vector<many_body_operator_generic<S>> make_operators(S t) {
+ using op_t = many_body_operator_generic<S>;
+ op_t hop, inter, mixed;
+ for (int i = 0; i < 3; ++i)
+  for (int j = 0; j < 3; ++j) hop += t * (i - 0.5 * j + 1) * c_dag<S>("up", i) * c<S>("up", j);
+ for (int i = 0; i < 3; ++i) inter += 2.0 * n<S>("up", i) * n<S>("dn", i) - 0.3 * c_dag<S>("up", i) * c_dag<S>("dn", i) * c<S>("dn", 2 - i) * c<S>("up", 2 - i);
+ mixed = op_t(1.5) + c<S>("dn", 1) - t * c_dag<S>("up", 0) + c<S>("up", 2) * c_dag<S>("up", 2) * c<S>("dn", 0);
+ return {hop, inter, mixed, hop + inter * mixed};
+}
+
+TEST(ManyBodyOperator, ProductReal) {
+ auto ops = make_operators<double>(0.7);
+ for (auto const& a : ops)
+  for (auto const& b : ops) check_product(a, b);
+}
+
+TEST(ManyBodyOperator, ProductComplex) {
+ auto ops = make_operators<std::complex<double>>(std::complex<double>(0.7, -0.2));
+ for (auto const& a : ops)
+  for (auto const& b : ops) check_product(a, dagger(b));
+}
+
+TEST(ManyBodyOperator, NormalOrdering) {
+ using op_t = many_body_operator_real;
+ EXPECT_TRUE((c<double>(0) * c_dag<double>(0) - op_t(1.0) + n<double>(0)).is_zero());
+ EXPECT_TRUE((c<double>(1) * c_dag<double>(0) + c_dag<double>(0) * c<double>(1)).is_zero());
+ EXPECT_TRUE((c<double>(0) * c<double>(1) + c<double>(1) * c<double>(0)).is_zero());
+ EXPECT_TRUE((c_dag<double>(0) * c_dag<double>(0)).is_zero());
+ // c_1 c_0 c+_0 c+_1 = (1 - n_0)(1 - n_1)
+ auto x = c<double>(1) * c<double>(0) * c_dag<double>(0) * c_dag<double>(1);
+ EXPECT_TRUE((x - (op_t(1.0) - n<double>(0)) * (op_t(1.0) - n<double>(1))).is_zero());
+ // the sign of the normal ordered monomial
+ auto y = c<double>(2) * c_dag<double>(1) * c_dag<double>(0);
+ ASSERT_EQ(1, y.get_monomials().size());
+ EXPECT_EQ(-1.0, y.get_monomials().begin()->second); // -c+_0 c+_1 c_2 : three transpositions
+}
+
+MAKE_MAIN;
@@ -0,0 +1,114 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/operators/many_body_operator.hpp>
+#include <triqs/utility/binary_archive.hpp>
+#include <triqs/h5/serialization.hpp>
+
+using triqs::utility::binary_serialize;
+using triqs::utility::binary_deserialize;
+using triqs::utility::binary_deserialize_into;
+
+template <typename T> T round_trip(T const &x) { return binary_deserialize<T>(binary_serialize(x)); }
+
+TEST(BinaryArchive, Basic) {
+ EXPECT_EQ(round_trip(127.5), 127.5);
+ EXPECT_EQ(round_trip(dcomplex(1, -2)), dcomplex(1, -2));
+ EXPECT_EQ(round_trip(std::string("abc")), "abc");
+ auto v = std::vector<std::string>{"abc", "", "3"};
+ EXPECT_EQ(round_trip(v), v);
+ auto vb = std::vector<bool>{true, false, true};
+ EXPECT_EQ(round_trip(vb), vb);
+ auto m = std::map<std::string, std::vector<double>>{{"a", {1, 2}}, {"b", {}}};
+ EXPECT_EQ(round_trip(m), m);
+ auto p = std::make_pair(3, std::string("x"));
+ EXPECT_EQ(round_trip(p), p);
+}
+
+TEST(BinaryArchive, Array) {
+ array<dcomplex, 3> a(4, 3, 5);
+ for (int i = 0; i < 4; ++i)
+  for (int j = 0; j < 3; ++j)
+   for (int k = 0; k < 5; ++k) a(i, j, k) = dcomplex(i, j * k);
+ EXPECT_ARRAY_EQ(round_trip(a), a);
+
+ // contiguous : the data as one block, after the header and the lengths
+ auto s = binary_serialize(a);
+ EXPECT_EQ(s.size(), 12 + 3 * 8 + 60 * sizeof(dcomplex));
+
+ // a strided view is written in C order
+ auto b = binary_deserialize<array<dcomplex, 2>>(binary_serialize(a(range(0, 4, 2), 1, range())));
+ EXPECT_ARRAY_EQ(b, a(range(0, 4, 2), 1, range()));
+
+ // Fortran order, and into a view
+ array<double, 2> f(3, 4, FORTRAN_LAYOUT);
+ for (int i = 0; i < 3; ++i)
+  for (int j = 0; j < 4; ++j) f(i, j) = 10 * i + j;
+ array<double, 2> big(6, 4);
+ big() = 0;
+ binary_deserialize_into(binary_serialize(f), big(range(0, 6, 2), range()));
+ EXPECT_ARRAY_EQ(big(range(0, 6, 2), range()), f);
+ EXPECT_THROW(binary_deserialize_into(binary_serialize(f), big(range(0, 2), range())), triqs::runtime_error);
+
+ matrix<double> mat{{1, 2}, {3, 4}};
+ EXPECT_ARRAY_EQ(round_trip(mat), mat);
+ auto as = array<std::string, 1>{"a", "bc"};
+ auto as2 = round_trip(as);
+ EXPECT_EQ(as2(1), "bc");
+}
+
+TEST(BinaryArchive, Objects) {
+ auto g = gf<imfreq>{{10, Fermion, 50}, {2, 2}};
+ clef::placeholder<0> w_;
+ g(w_) << 1 / (w_ + 2.5);
+ auto g2 = round_trip(g);
+ EXPECT_GF_NEAR(g, g2);
+ EXPECT_ARRAY_NEAR(g.singularity().data(), g2.singularity().data());
+
+ // much smaller than the h5 serialization
+ EXPECT_LT(binary_serialize(g.singularity()).size(), triqs::h5::serialize(g.singularity()).size() / 4);
+
+ using namespace triqs::operators;
+ auto h = 2 * n("up", 0) * n("dn", 0) - 0.5 * (c_dag("up", 0) * c("dn", 1) + 1_j * c_dag("dn", 1) * c("up", 0));
+ auto h2 = round_trip(h);
+ EXPECT_TRUE((h - h2).is_zero());
+ EXPECT_FALSE(h2.is_zero());
+}
+
+TEST(BinaryArchive, Errors) {
+ auto s = binary_serialize(std::vector<double>(10, 1.0));
+ EXPECT_THROW(binary_deserialize<std::vector<double>>(s.substr(0, s.size() - 1)), triqs::runtime_error);
+ EXPECT_THROW(binary_deserialize<double>(std::string(20, 'x')), triqs::runtime_error);
+ s[4] = 2; // a format more recent
+ EXPECT_THROW(binary_deserialize<std::vector<double>>(s), triqs::runtime_error);
+}
+
+// An archive announcing a huge size : an error, and no allocation
+template <typename T> void check_corrupted_size(T const &x) {
+ auto s = binary_serialize(x);
+ std::uint64_t huge = std::uint64_t(1) << 60;
+ std::memcpy(&s[12], &huge, sizeof(huge)); // the size follows the header of 12 bytes
+ EXPECT_THROW(binary_deserialize<T>(s), triqs::runtime_error);
+ EXPECT_THROW(binary_deserialize<T>(s.substr(0, 20)), triqs::runtime_error);
+}
+
+TEST(BinaryArchive, CorruptedSize) {
+ using matrix_t = array<double, 2>;
+ check_corrupted_size(std::vector<double>(10, 1.0));
+ check_corrupted_size(std::string("abcdef"));
+ check_corrupted_size(std::vector<std::string>{"abc", "", "3"});
+ check_corrupted_size(std::vector<bool>{true, false});
+ check_corrupted_size(matrix_t(3, 4));
+ check_corrupted_size(array<dcomplex, 3>(2, 3, 1));
+
+ // the product of the lengths of an array overflows
+ auto s = binary_serialize(matrix_t(3, 4));
+ std::uint64_t l = std::uint64_t(1) << 40;
+ std::memcpy(&s[12], &l, sizeof(l));
+ std::memcpy(&s[20], &l, sizeof(l));
+ EXPECT_THROW(binary_deserialize<matrix_t>(s), triqs::runtime_error);
+
+ // a truncated vector of strings
+ auto sv = binary_serialize(std::vector<std::string>{"abc", "def"});
+ EXPECT_THROW(binary_deserialize<std::vector<std::string>>(sv.substr(0, sv.size() - 1)), triqs::runtime_error);
+}
+
+MAKE_MAIN;
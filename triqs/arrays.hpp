@@ -37,6 +37,7 @@
 // HDF5 interface
 #include <triqs/arrays/h5/simple_read_write.hpp>
 #include <triqs/arrays/h5/array_of_non_basic.hpp>
+#include <triqs/arrays/h5/mapped_read.hpp>
 
 // Regrouping indices
 #include <triqs/arrays/group_indices.hpp>
@@ -45,4 +46,5 @@
 #include <triqs/arrays/linalg/det_and_inverse.hpp>
 
 #include <triqs/arrays/mpi.hpp>
+#include <triqs/arrays/h5/distributed.hpp>
 
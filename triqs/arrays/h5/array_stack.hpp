@@ -24,6 +24,11 @@
 #include <triqs/h5.hpp>
 #include "./simple_read_write.hpp"
 #include <triqs/h5/base.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <iostream>
 
 namespace triqs {
 namespace arrays {
@@ -40,6 +45,12 @@ namespace arrays {
   }
  }
 
+ /// How an array_stack writes its buffer
+ enum class array_stack_mode {
+  sync, // by the calling thread, when the buffer is full
+  async // by a background thread, while the calling thread fills a second buffer. Only with a thread safe HDF5 library, else sync
+ };
+
  /// The implementation class
  template <typename T, int R> class array_stack_impl {
   static const size_t dim = R;
@@ -51,9 +62,21 @@ namespace arrays {
   h5::dataset d_set;
   array<T, dim + 1> buffer;
 
+  // async mode : the buffer being written, and the writer thread
+  array_stack_mode mode;
+  array<T, dim + 1> buffer_w;
+  size_t step_w = 0;
+  bool pending = false, stop = false;
+  std::exception_ptr error;
+  std::mutex mut;
+  std::condition_variable cv;
+  std::thread writer;
+
   public:
-  array_stack_impl(h5::group g, std::string const &name, mini_vector<size_t, dim> const &base_element_shape, size_t bufsize) {
-   mini_vector<hsize_t, RANK> dim_chunk;
+  array_stack_impl(h5::group g, std::string const &name, mini_vector<size_t, dim> base_element_shape, size_t bufsize,
+                   array_stack_mode mode = array_stack_mode::sync, size_t chunk_size = 0)
+     // The writer thread calls HDF5 while the other threads may use it too : this requires a thread safe library
+     : mode(h5::library_is_threadsafe() ? mode : array_stack_mode::sync) {
    bufsize_ = bufsize;
    step = 0;
    _size = 0;
@@ -68,7 +91,12 @@ namespace arrays {
    dim_chunk = dims;
    dims[0] = 0;
    maxdims[0] = H5S_UNLIMITED;
-   dim_chunk[0] = 1;
+   // Default chunk : the buffer (a chunk per element makes the metadata explode),
+   // but not more than about chunk_bytes of the write policy (HDF5 limits a chunk to 4 GB)
+   size_t element_bytes = sizeof(T);
+   for (size_t i = 1; i <= dim; ++i) element_bytes *= std::max<size_t>(1, dims[i]);
+   size_t max_chunk = std::max<size_t>(1, g.get_write_policy().chunk_bytes / element_bytes);
+   dim_chunk[0] = (chunk_size > 0 ? chunk_size : std::min(bufsize_, max_chunk));
    buffer_dim[0] = bufsize_;
    mini_vector<size_t, dim + 1> s;
    for (size_t i = 0; i <= dim; ++i) {
@@ -76,15 +104,35 @@ namespace arrays {
    }
    buffer.resize(s);
    h5::dataspace mspace1 = H5Screate_simple(RANK, dims.ptr(), maxdims.ptr());
-   h5::proplist cparms = H5Pcreate(H5P_DATASET_CREATE);
-   //auto err = H5Pset_chunk(cparms, RANK, dim_chunk.ptr());
-   H5Pset_chunk(cparms, RANK, dim_chunk.ptr());
+   using real_t = std14::conditional_t<T_is_complex, double, T>;
+   h5::proplist cparms =
+       h5::chunked_dataset_creation_proplist(g.get_write_policy(), RANK, dim_chunk.ptr(), std::is_floating_point<real_t>::value);
    d_set = g.create_dataset(name, h5::native_type_from_C(T()), mspace1, cparms);
    if (triqs::is_complex<T>::value) h5_write_attribute(d_set, "__complex__", "1");
+   if (this->mode == array_stack_mode::async) {
+    buffer_w.resize(s);
+    writer = std::thread([this]() { this->writer_loop(); });
+   }
+  }
+
+  /// Flush the buffer. An error can not be thrown from the destructor : it is reported on std::cerr. Call flush() to catch it.
+  ~array_stack_impl() {
+   try {
+    flush();
+   } catch (std::exception const &e) {
+    std::cerr << "array_stack : the last elements could not be written : " << e.what() << std::endl;
+   }
+   if (writer.joinable()) {
+    {
+     std::lock_guard<std::mutex> lock(mut);
+     stop = true;
+    }
+    cv.notify_all();
+    writer.join();
+   }
   }
 
-  ///
-  ~array_stack_impl() { flush(); }
+  array_stack_impl(array_stack_impl const &) = delete;
 
 #ifdef TRIQS_DOXYGEN
   /// A view (for an array/matrix/vector base) or a reference (for a scalar base) to the top of the stack i.e. the next element to be assigned to
@@ -101,12 +149,25 @@ namespace arrays {
   void operator++() {
    ++step;
    ++_size;
-   if (step == bufsize_) flush();
+   if (step == bufsize_) {
+    if (mode == array_stack_mode::async)
+     hand_over();
+    else
+     flush();
+   }
   }
 
   /// Flush the buffer to the disk. Automatically called at destruction.
+  /// In async mode, waits until all the elements are written, and rethrows an error of the writer thread.
   void flush() {
-   save_buffer();
+   if (mode == array_stack_mode::async) {
+    hand_over();
+    std::unique_lock<std::mutex> lock(mut);
+    cv.wait(lock, [this] { return !pending; });
+    rethrow_writer_error();
+    return;
+   }
+   save_buffer(buffer, step);
    step = 0;
   }
 
@@ -122,25 +183,70 @@ namespace arrays {
   /// Current size of the stack
   size_t size() const { return _size; }
 
+  /// The mode actually used : sync if async was requested with a HDF5 library which is not thread safe
+  array_stack_mode get_mode() const { return mode; }
+
   private:
-  void save_buffer() {
+  // async : give the buffer to the writer, after it has written the previous one (hence at most two buffers in memory)
+  void hand_over() {
    if (step == 0) return;
-   dims[0] += step;
-   buffer_dim[0] = step;
+   {
+    std::unique_lock<std::mutex> lock(mut);
+    cv.wait(lock, [this] { return !pending; });
+    rethrow_writer_error();
+    swap(buffer, buffer_w);
+    step_w = step;
+    pending = true;
+   }
+   cv.notify_all();
+   step = 0;
+  }
+
+  // with the lock
+  void rethrow_writer_error() {
+   if (!error) return;
+   auto e = error;
+   error = nullptr;
+   std::rethrow_exception(e);
+  }
+
+  void writer_loop() {
+   std::unique_lock<std::mutex> lock(mut);
+   while (true) {
+    cv.wait(lock, [this] { return pending || stop; });
+    if (!pending) return;
+    lock.unlock();
+    try {
+     save_buffer(buffer_w, step_w);
+    } catch (...) {
+     lock.lock();
+     error = std::current_exception();
+     lock.unlock();
+    }
+    lock.lock();
+    pending = false;
+    cv.notify_all();
+   }
+  }
+
+  void save_buffer(array<T, dim + 1> &buf, size_t n) {
+   if (n == 0) return;
+   dims[0] += n;
+   buffer_dim[0] = n;
 
    herr_t err= H5Dset_extent(d_set,dims.ptr());  // resize the data_space
 
    h5::dataspace fspace1 = H5Dget_space(d_set);
-   h5::dataspace mspace = h5_impl::data_space(buffer);
+   h5::dataspace mspace = h5_impl::data_space(buf);
 
    err = H5Sselect_hyperslab(fspace1, H5S_SELECT_SET, offset.ptr(), NULL, buffer_dim.ptr(), NULL);
    if (err < 0) TRIQS_RUNTIME_ERROR << "Cannot set hyperslab";
    err = H5Sselect_hyperslab(mspace, H5S_SELECT_SET, zero.ptr(), NULL, buffer_dim.ptr(), NULL);
    if (err < 0) TRIQS_RUNTIME_ERROR << "Cannot set hyperslab";
 
-   err = H5Dwrite(d_set, h5::data_type_memory<T>(), mspace, fspace1, H5P_DEFAULT, h5_impl::__get_array_data_ptr(buffer));
+   err = H5Dwrite(d_set, h5::data_type_memory<T>(), mspace, fspace1, H5P_DEFAULT, h5_impl::__get_array_data_ptr(buf));
    if (err < 0) TRIQS_RUNTIME_ERROR << "Error writing the array_stack buffer";
-   offset[0] += step;
+   offset[0] += n;
   }
  };
 
@@ -155,10 +261,13 @@ namespace arrays {
    *  \param g The h5 group
    *  \param name The name of the hdf5 array in the file/group where the stack will be stored
    *  \param bufsize The size of the buffer
+   *  \param mode In async mode, the buffer is written by a background thread, while a second buffer is filled
+   *  \param chunk_size The size of the HDF5 chunks along the stack. Default : bufsize
    *  \exception The HDF5 exceptions will be caught and rethrown as TRIQS_RUNTIME_ERROR (with stackstrace, cf doc).
    */
-  array_stack(h5::group g, std::string const &name, size_t bufsize)
-     : array_stack_impl<T, 0>{g, name, mini_vector<size_t, 0>{}, bufsize} {}
+  array_stack(h5::group g, std::string const &name, size_t bufsize, array_stack_mode mode = array_stack_mode::sync,
+              size_t chunk_size = 0)
+     : array_stack_impl<T, 0>{g, name, mini_vector<size_t, 0>{}, bufsize, mode, chunk_size} {}
  };
 
  // Specialisation for The simple case, 1d
@@ -170,10 +279,13 @@ namespace arrays {
     *  \param name The name of the hdf5 array in the file/group where the stack will be stored
     *  \param base_element_shape The shape of the base array of the stack.
     *  \param bufsize The size of the buffer
+    *  \param mode In async mode, the buffer is written by a background thread, while a second buffer is filled
+    *  \param chunk_size The size of the HDF5 chunks along the stack. Default : bufsize
     *  \exception The HDF5 exceptions will be caught and rethrown as TRIQS_RUNTIME_ERROR (with stackstrace, cf doc).
     */
-  array_stack(h5::group g, std::string const &name, mini_vector<size_t,N> const &base_element_shape, size_t bufsize)
-     : array_stack_impl<T, N>{g, name, base_element_shape, bufsize} {}
+  array_stack(h5::group g, std::string const &name, mini_vector<size_t,N> const &base_element_shape, size_t bufsize,
+              array_stack_mode mode = array_stack_mode::sync, size_t chunk_size = 0)
+     : array_stack_impl<T, N>{g, name, base_element_shape, bufsize, mode, chunk_size} {}
  };
 }
 } // namespace
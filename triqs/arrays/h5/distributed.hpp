@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2011-2014 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./simple_read_write.hpp"
+#include "../mpi.hpp"
+
+namespace triqs {
+namespace arrays {
+
+ namespace h5_impl {
+
+  // Write a into the rows [first, first + first_dim(a)) of the existing dataset name
+  template <typename A> void write_rows(h5::group g, std::string const& name, A const& a, long first) {
+   hyperslab h;
+   auto sh = a.shape();
+   for (int u = 0; u < A::rank; ++u) {
+    h.offset.push_back(u == 0 ? first : 0);
+    h.stride.push_back(1);
+    h.count.push_back(sh[u]);
+    h.is_range.push_back(true);
+   }
+   auto b = make_const_cache(a).view();
+   write_array_slice_impl(g, name, b.data_start(), array_stride_info{b}, h);
+  }
+ }
+
+ /// Write an array distributed over the nodes of a communicator (e.g. by mpi_scatter) into a single dataset. Collective.
+ /**
+  * The local arrays are the consecutive slices, in the order of the ranks, of the first dimension of the dataset.
+  * Their other dimensions must be equal.
+  *
+  * If the file of g is opened on c with the MPI-IO driver (cf h5::file), each node writes its own slice (hyperslab)
+  * in a collective write, without any communication of the data.
+  * Otherwise (serial HDF5 library), g is used on the root only and may be empty on the other nodes :
+  * the root receives and writes the slices one after the other, hence never holds more than one slice in memory.
+  */
+ template <typename A>
+ std14::enable_if_t<is_amv_value_or_view_class<A>::value> h5_write_distributed(h5::group g, std::string const& name, A const& a,
+                                                                               mpi::communicator c = {}, int root = 0) {
+  using T = typename A::value_type;
+  constexpr int R = A::rank;
+  static_assert(is_scalar<T>::value, "h5_write_distributed : only for arrays of numbers");
+
+  // the shape of the dataset, the slices must agree on the other dimensions
+  auto sh = a.shape(), sh_root = sh;
+  long n = sh[0];
+  MPI_Bcast(&sh_root[0], R, mpi::mpi_datatype<size_t>(), root, c.get());
+  int mismatch = 0;
+  for (int u = 1; u < R; ++u) mismatch = mismatch || (sh[u] != sh_root[u]);
+  if (mpi::mpi_all_reduce(mismatch, c))
+   TRIQS_RUNTIME_ERROR << "h5_write_distributed : the arrays of the nodes differ in the dimensions other than the first one";
+  auto full = sh;
+  full[0] = mpi::mpi_all_reduce(n, c);
+
+  if (g.is_parallel()) {
+   long first = 0;
+   MPI_Exscan(&n, &first, 1, MPI_LONG, MPI_SUM, c.get());
+   if (c.rank() == 0) first = 0; // the output of Exscan is undefined on rank 0
+   g.unlink_key_if_exists(name);
+   h5_create_array_dataset<T>(g, name, full);
+   h5_impl::write_rows(g, name, a, first);
+   return;
+  }
+
+  std::vector<long> sizes(c.size());
+  MPI_Gather(&n, 1, MPI_LONG, sizes.data(), 1, MPI_LONG, root, c.get());
+  const int tag = 1234;
+  if (c.rank() != root) {
+   if (n == 0) return;
+   array<T, R> tmp = a; // contiguous
+   MPI_Send(tmp.data_start(), tmp.domain().number_of_elements(), mpi::mpi_datatype<T>(), root, tag, c.get());
+   return;
+  }
+  g.unlink_key_if_exists(name);
+  h5_create_array_dataset<T>(g, name, full);
+  long first = 0;
+  for (int r = 0; r < c.size(); ++r) {
+   if (r == root)
+    h5_impl::write_rows(g, name, a, first);
+   else if (sizes[r] > 0) {
+    auto sh_r = sh;
+    sh_r[0] = sizes[r];
+    array<T, R> buf(sh_r);
+    MPI_Recv(buf.data_start(), buf.domain().number_of_elements(), mpi::mpi_datatype<T>(), r, tag, c.get(), MPI_STATUS_IGNORE);
+    h5_impl::write_rows(g, name, buf, first);
+   }
+   first += sizes[r];
+  }
+ }
+}
+}
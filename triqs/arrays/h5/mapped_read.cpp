@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2016 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "./mapped_read.hpp"
+#include "./../../h5/base.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define TRIQS_H5_CAN_MMAP
+#endif
+
+using dcomplex = std::complex<double>;
+namespace triqs {
+namespace arrays {
+ namespace h5_impl {
+
+  // The offset of the data of the dataset in the file, if it can be mapped as an array of T, -1 otherwise
+  template <typename T> static long mappable_offset(h5::dataset const &ds, bool is_complex) {
+#ifndef TRIQS_H5_CAN_MMAP
+   return -1;
+#else
+   if (is_complex != triqs::is_complex<T>::value) return -1;
+   h5::h5_object f = H5Iget_file_id(ds);
+   h5::proplist fapl = H5Fget_access_plist(f);
+   if (H5Pget_driver(fapl) != H5FD_SEC2) return -1;
+   h5::proplist dcpl = H5Dget_create_plist(ds);
+   if (H5Pget_layout(dcpl) != H5D_CONTIGUOUS) return -1;
+   h5::datatype ty = H5Dget_type(ds);
+   if (H5Tequal(ty, h5::data_type_memory<T>()) <= 0) return -1; // e.g. another byte order
+   haddr_t offset = H5Dget_offset(ds);                            // undefined if the data is not allocated
+   if (offset == HADDR_UNDEF) return -1;
+   if (offset % alignof(T) != 0) return -1; // e.g. after a dataset of an odd number of bytes : no T* on it
+   return offset;
+#endif
+  }
+
+  template <typename T> bool can_map_dataset(h5::group g, std::string const &name) {
+   h5::dataset ds = g.open_dataset(name);
+   return mappable_offset<T>(ds, is_dataset_complex(g, name)) >= 0;
+  }
+
+  template <typename T> mapped_dataset map_dataset(h5::group g, std::string const &name) {
+   mapped_dataset res;
+#ifdef TRIQS_H5_CAN_MMAP
+   h5::dataset ds = g.open_dataset(name);
+   bool is_complex = is_dataset_complex(g, name);
+   long offset = mappable_offset<T>(ds, is_complex);
+   if (offset < 0) return res;
+   res.lengths = get_dataset_lengths(g, name, is_complex);
+   size_t n_bytes = sizeof(T);
+   for (auto l : res.lengths) n_bytes *= l;
+   if (n_bytes == 0) return res;
+
+   // the data written through this file must be on disk
+   unsigned intent;
+   h5::h5_object f = H5Iget_file_id(ds);
+   if ((H5Fget_intent(f, &intent) >= 0) && (intent & H5F_ACC_RDWR)) H5Fflush(ds, H5F_SCOPE_LOCAL);
+   ssize_t l = H5Fget_name(ds, NULL, 0);
+   if (l <= 0) return res;
+   std::vector<char> filename(l + 1);
+   H5Fget_name(ds, filename.data(), l + 1);
+
+   int fd = ::open(filename.data(), O_RDONLY);
+   if (fd < 0) return res;
+   long page = sysconf(_SC_PAGESIZE);
+   long start = (offset / page) * page; // mmap wants a multiple of the page size
+   size_t length = n_bytes + (offset - start);
+   void *p = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, start);
+   ::close(fd); // the mapping stays valid
+   if (p == MAP_FAILED) return res;
+   res.owner = std::shared_ptr<void>(p, [length](void *p) { ::munmap(p, length); });
+   res.data = static_cast<char const *>(p) + (offset - start);
+#endif
+   return res;
+  }
+
+#define TRIQS_H5_MAP_INSTANTIATE(T)                                                                                                   \
+  template mapped_dataset map_dataset<T>(h5::group, std::string const &);                                                            \
+  template bool can_map_dataset<T>(h5::group, std::string const &);
+  TRIQS_H5_MAP_INSTANTIATE(int);
+  TRIQS_H5_MAP_INSTANTIATE(long);
+  TRIQS_H5_MAP_INSTANTIATE(double);
+  TRIQS_H5_MAP_INSTANTIATE(dcomplex);
+#undef TRIQS_H5_MAP_INSTANTIATE
+ }
+}
+}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2016 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./simple_read_write.hpp"
+#include <memory>
+
+namespace triqs {
+namespace arrays {
+ namespace h5_impl {
+
+  // A dataset mapped in memory : its first element (null if the dataset cannot be mapped),
+  // the owner of the mapping, and the lengths of the dataset (without the last dimension of a complex dataset)
+  struct mapped_dataset {
+   void const *data = nullptr;
+   std::shared_ptr<void> owner;
+   std::vector<size_t> lengths;
+  };
+
+  template <typename T> mapped_dataset map_dataset(h5::group g, std::string const &name);
+  template <typename T> bool can_map_dataset(h5::group g, std::string const &name);
+ }
+
+ /// True iif h5_read_mapped<T,R>(g, name) maps the dataset instead of reading it
+ template <typename T> bool h5_can_map(h5::group g, std::string const &name) { return h5_impl::can_map_dataset<T>(g, name); }
+
+ /// Read a dataset as a const view on a memory mapping of the file, without copy
+ /**
+  * The dataset is mapped iif it is contiguous (not chunked, hence not compressed), allocated,
+  * of the same type and byte order as T in memory, in a file opened with the default (sec2) driver,
+  * on a POSIX system. Otherwise, it is read into a new array, and a view of it is returned.
+  *
+  * The data is then paged in lazily by the system, and the processes of a node share the page cache.
+  * The mapping lives as long as a view on it, even after the file is closed.
+  * NB : Do not overwrite the dataset (or delete it and repack the file) while a view on it is alive.
+  *
+  * @tparam T The value type (int, long, double, dcomplex)
+  * @tparam R The rank of the array
+  */
+ template <typename T, int R> array_const_view<T, R> h5_read_mapped(h5::group g, std::string const &name) {
+  static_assert(is_scalar<T>::value, "h5_read_mapped : only for arrays of numbers");
+  auto m = h5_impl::map_dataset<T>(g, name);
+  if (m.data == nullptr) {
+   array<T, R> a;
+   h5_read(g, name, a);
+   return a;
+  }
+  if (m.lengths.size() != R)
+   TRIQS_RUNTIME_ERROR << "h5_read_mapped : the dataset " << name << " has rank " << m.lengths.size() << ", expected " << R;
+  mini_vector<size_t, R> L(m.lengths);
+  size_t n = 1;
+  for (auto l : m.lengths) n *= l;
+  using view_t = array_const_view<T, R>;
+  return view_t{typename view_t::indexmap_type(L), storages::shared_block<T>(const_cast<T *>(static_cast<T const *>(m.data)), n, m.owner)};
+ }
+}
+}
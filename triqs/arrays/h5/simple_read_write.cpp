@@ -20,6 +20,7 @@
  ******************************************************************************/
 #include "./simple_read_write.hpp"
 #include "./../../h5/base.hpp"
+#include <algorithm>
 
 using dcomplex = std::complex<double>;
 namespace triqs {
@@ -48,7 +49,13 @@ namespace arrays {
   template <typename T> void write_array_impl(h5::group g, std::string const& name, const T* start, array_stride_info info) {
    static_assert(!std::is_base_of<std::string, T>::value, " Not implemented"); // 1d is below
    bool is_complex = triqs::is_complex<T>::value;
-   h5::dataset ds = g.create_dataset(name, h5::data_type_file<T>(), data_space_impl(info, is_complex));
+   int rank = info.R + (is_complex ? 1 : 0);
+   hsize_t dims[rank];
+   for (int u = 0; u < info.R; ++u) dims[u] = info.lengths[u];
+   if (is_complex) dims[rank - 1] = 2;
+   using real_t = std14::conditional_t<triqs::is_complex<T>::value, double, T>; // complex are stored as pairs of double
+   auto pl = h5::dataset_creation_proplist(g.get_write_policy(), rank, dims, sizeof(real_t), std::is_floating_point<real_t>::value);
+   h5::dataset ds = g.create_dataset(name, h5::data_type_file<T>(), data_space_impl(info, is_complex), pl);
 
    auto err =
        H5Dwrite(ds, h5::data_type_memory<T>(), data_space_impl(info, is_complex), H5S_ALL, H5P_DEFAULT, h5::get_data_ptr(start));
@@ -109,6 +116,85 @@ namespace arrays {
   template void read_array_impl<double>(h5::group g, std::string const& name, double* start, array_stride_info info);
   template void read_array_impl<dcomplex>(h5::group g, std::string const& name, dcomplex* start, array_stride_info info);
 
+  /// --------------------------- SLICES ---------------------------------------------
+
+  std::vector<size_t> get_dataset_lengths(h5::group g, std::string const& name, bool is_complex) {
+   h5::dataset ds = g.open_dataset(name);
+   h5::dataspace d_space = H5Dget_space(ds);
+   int rank = H5Sget_simple_extent_ndims(d_space);
+   hsize_t dims_out[rank];
+   H5Sget_simple_extent_dims(d_space, dims_out, NULL);
+   int R = rank - (is_complex ? 1 : 0);
+   if (R < 0) TRIQS_RUNTIME_ERROR << "The dataset " << name << " is not a complex array";
+   return std::vector<size_t>(dims_out, dims_out + R);
+  }
+
+  static bool is_empty(hyperslab const& h) { return std::find(h.count.begin(), h.count.end(), 0) != h.count.end(); }
+
+  // the file dataspace of ds, with the selection of the hyperslab h
+  static h5::dataspace file_space_of_slice(h5::dataset const& ds, hyperslab const& h, bool is_complex) {
+   h5::dataspace d_space = H5Dget_space(ds);
+   int rank = h.offset.size() + (is_complex ? 1 : 0);
+   hsize_t offset[rank], stride[rank], count[rank];
+   for (int u = 0; u < int(h.offset.size()); ++u) {
+    offset[u] = h.offset[u];
+    stride[u] = h.stride[u];
+    count[u] = h.count[u];
+   }
+   if (is_complex) {
+    offset[rank - 1] = 0;
+    stride[rank - 1] = 1;
+    count[rank - 1] = 2;
+   }
+   herr_t err = (is_empty(h) ? H5Sselect_none(d_space) : H5Sselect_hyperslab(d_space, H5S_SELECT_SET, offset, stride, count, NULL));
+   if (err < 0) TRIQS_RUNTIME_ERROR << "Cannot set hyperslab";
+   return d_space;
+  }
+
+  template <typename T> void read_array_slice_impl(h5::group g, std::string const& name, T* start, array_stride_info info, hyperslab const& h) {
+   bool is_complex = triqs::is_complex<T>::value;
+   h5::dataset ds = g.open_dataset(name);
+   herr_t err = H5Dread(ds, h5::data_type_memory<T>(), data_space_impl(info, is_complex), file_space_of_slice(ds, h, is_complex),
+                        H5P_DEFAULT, h5::get_data_ptr(start));
+   if (err < 0) TRIQS_RUNTIME_ERROR << "Error reading a slice of the dataset " << name << " in the group" << g.name();
+  }
+
+  template <typename T>
+  void write_array_slice_impl(h5::group g, std::string const& name, const T* start, array_stride_info info, hyperslab const& h) {
+   bool is_complex = triqs::is_complex<T>::value;
+   h5::dataset ds = g.open_dataset(name);
+   h5::dataspace f_space = file_space_of_slice(ds, h, is_complex);
+   // an empty slice still takes part in a collective write (MPI-IO), with an empty selection
+   h5::dataspace m_space = (is_empty(h) ? f_space : data_space_impl(info, is_complex));
+   herr_t err = H5Dwrite(ds, h5::data_type_memory<T>(), m_space, f_space, h5::dataset_transfer_proplist(g), h5::get_data_ptr(start));
+   if (err < 0) TRIQS_RUNTIME_ERROR << "Error writing a slice of the dataset " << name << " in the group" << g.name();
+  }
+
+  template <typename T> void create_array_dataset_impl(h5::group g, std::string const& name, int R, size_t const* lengths) {
+   bool is_complex = triqs::is_complex<T>::value;
+   int rank = R + (is_complex ? 1 : 0);
+   hsize_t dims[rank];
+   for (int u = 0; u < R; ++u) dims[u] = lengths[u];
+   if (is_complex) dims[rank - 1] = 2;
+   using real_t = std14::conditional_t<triqs::is_complex<T>::value, double, T>;
+   auto pl = h5::dataset_creation_proplist(g.get_write_policy(), rank, dims, sizeof(real_t), std::is_floating_point<real_t>::value);
+   h5::dataspace d_space = H5Screate_simple(rank, dims, NULL);
+   h5::dataset ds = g.create_dataset(name, h5::data_type_file<T>(), d_space, pl);
+   if (is_complex) h5_write_attribute(ds, "__complex__", "1");
+  }
+
+#define TRIQS_H5_SLICE_INSTANTIATE(T)                                                                                                 \
+  template void read_array_slice_impl<T>(h5::group, std::string const&, T*, array_stride_info, hyperslab const&);                   \
+  template void write_array_slice_impl<T>(h5::group, std::string const&, const T*, array_stride_info, hyperslab const&);            \
+  template void create_array_dataset_impl<T>(h5::group, std::string const&, int, size_t const*);
+  TRIQS_H5_SLICE_INSTANTIATE(int);
+  TRIQS_H5_SLICE_INSTANTIATE(long);
+  TRIQS_H5_SLICE_INSTANTIATE(double);
+  TRIQS_H5_SLICE_INSTANTIATE(dcomplex);
+#undef TRIQS_H5_SLICE_INSTANTIATE
+
+  /// --------------------------- READ strings ---------------------------------------------
+
   void read_array(h5::group g, std::string const& name, arrays::vector<std::string>& V) {
    std::vector<std::string> tmp;
    h5_read(g, name, tmp);
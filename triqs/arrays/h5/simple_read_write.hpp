@@ -103,6 +103,68 @@ namespace arrays {
   void read_array(h5::group g, std::string const& name, arrays::vector<std::string>& V);
   void read_array(h5::group f, std::string const& name, arrays::array<std::string, 1>& V);
 
+  /*********************************** Slices (hyperslabs) ****************************************************************/
+
+  // The hyperslab of a dataset : for each dimension of the dataset (complex excluded), the first index, the step
+  // and the number of indices. A dimension given by an integer is not a dimension of the array in memory.
+  struct hyperslab {
+   std::vector<long> offset, stride, count;
+   std::vector<bool> is_range;
+  };
+
+  // Lengths of a dataset, without the last dimension of a complex dataset
+  std::vector<size_t> get_dataset_lengths(h5::group g, std::string const& name, bool is_complex);
+
+  inline void fill_hyperslab(std::vector<size_t> const&, hyperslab&) {}
+
+  template <typename... R>
+  void fill_hyperslab(std::vector<size_t> const& lengths, hyperslab& h, range const& r, R const&... rest);
+
+  template <typename... R> void fill_hyperslab(std::vector<size_t> const& lengths, hyperslab& h, long i, R const&... rest) {
+   h.offset.push_back(i);
+   h.stride.push_back(1);
+   h.count.push_back(1);
+   h.is_range.push_back(false);
+   fill_hyperslab(lengths, h, rest...);
+  }
+
+  template <typename... R>
+  void fill_hyperslab(std::vector<size_t> const& lengths, hyperslab& h, range const& r, R const&... rest) {
+   long L = lengths[h.offset.size()], last = (r.last() == -1 ? L : r.last());
+   h.offset.push_back(r.first());
+   h.stride.push_back(r.step());
+   h.count.push_back(std::max(0l, (last - r.first() + r.step() - 1) / r.step())); // python behaviour, as for the arrays
+   h.is_range.push_back(true);
+   fill_hyperslab(lengths, h, rest...);
+  }
+
+  template <typename... R> hyperslab make_hyperslab(h5::group g, std::string const& name, bool is_complex, R const&... r) {
+   auto lengths = get_dataset_lengths(g, name, is_complex);
+   if (lengths.size() != sizeof...(R))
+    TRIQS_RUNTIME_ERROR << "h5 slice : the dataset " << name << " has rank " << lengths.size() << " but the slice has " << sizeof...(R)
+                        << " indices or ranges";
+   hyperslab h;
+   fill_hyperslab(lengths, h, r...);
+   for (int u = 0; u < int(lengths.size()); ++u)
+    if ((h.offset[u] < 0) || (h.stride[u] <= 0) || ((h.count[u] > 0) && (h.offset[u] + (h.count[u] - 1) * h.stride[u] >= long(lengths[u]))))
+     TRIQS_RUNTIME_ERROR << "h5 slice : the slice is out of the dataset " << name << " in dimension " << u;
+   return h;
+  }
+
+  template <typename T> void read_array_slice_impl(h5::group g, std::string const& name, T* start, array_stride_info info, hyperslab const& h);
+  template <typename T>
+  void write_array_slice_impl(h5::group g, std::string const& name, const T* start, array_stride_info info, hyperslab const& h);
+  template <typename T> void create_array_dataset_impl(h5::group g, std::string const& name, int R, size_t const* lengths);
+
+  template <typename A> mini_vector<size_t, A::rank> slice_lengths(hyperslab const& h) {
+   std::vector<size_t> res;
+   for (int u = 0; u < int(h.count.size()); ++u)
+    if (h.is_range[u]) res.push_back(h.count[u]);
+   if (res.size() != A::rank)
+    TRIQS_RUNTIME_ERROR << "h5 slice : the slice has " << res.size() << " ranges, for an array of rank " << int(A::rank);
+   return mini_vector<size_t, A::rank>(res);
+  }
+
  } // namespace h5_impl
 
  // a trait to detect if A::value_type exists and is a scalar or a string
@@ -150,5 +212,57 @@ namespace arrays {
   h5_impl::write_array(g, name, array_const_view<typename ArrayType::value_type, ArrayType::rank>(A));
  }
 
+ /// Read a part of a dataset into an array (resized) or a view (of the correct shape)
+ /**
+  * Only the selected part is read from the file, as a hyperslab.
+  * @param r One index (long) or range per dimension of the dataset. The rank of A is the number of ranges.
+  *
+  *   h5_read_slice(g, "data", A, 5, range(), range(0, 10, 2)); // A = data(5, :, 0:10:2)
+  */
+ template <typename ArrayType, typename... R>
+ std14::enable_if_t<is_amv_value_or_view_class<std14::decay_t<ArrayType>>::value>
+ h5_read_slice(h5::group g, std::string const& name, ArrayType&& A, R const&... r) {
+  using A_t = std14::decay_t<ArrayType>;
+  using T = typename A_t::value_type;
+  static_assert(is_scalar<T>::value, "h5_read_slice : only for arrays of numbers");
+  constexpr bool is_complex = triqs::is_complex<T>::value;
+  if (is_complex && !h5_impl::is_dataset_complex(g, name)) { // if not complex in file, we load in real and assign
+   array<double, A_t::rank> tmp;
+   h5_read_slice(g, name, tmp, r...);
+   A = tmp;
+   return;
+  }
+  auto h = h5_impl::make_hyperslab(g, name, is_complex, r...);
+  h5_impl::resize_or_check(A, h5_impl::slice_lengths<A_t>(h));
+  auto b = make_cache(A);
+  h5_impl::read_array_slice_impl(g, name, b.view().data_start(), h5_impl::array_stride_info{b.view()}, h);
+ }
+
+ /// Write an array (or a view) into a part of an existing dataset
+ /**
+  * Only the selected part of the file is written, as a hyperslab.
+  * The dataset must exist with the correct type, e.g. created by h5_create_array_dataset.
+  * @param r One index (long) or range per dimension of the dataset. The rank of A is the number of ranges.
+  */
+ template <typename ArrayType, typename... R>
+ std14::enable_if_t<is_amv_value_or_view_class<ArrayType>::value> h5_write_slice(h5::group g, std::string const& name,
+                                                                                 ArrayType const& A, R const&... r) {
+  using T = typename ArrayType::value_type;
+  static_assert(is_scalar<T>::value, "h5_write_slice : only for arrays of numbers");
+  constexpr bool is_complex = triqs::is_complex<T>::value;
+  if (is_complex != h5_impl::is_dataset_complex(g, name))
+   TRIQS_RUNTIME_ERROR << "h5_write_slice : the array and the dataset " << name << " are not both complex or both real";
+  auto h = h5_impl::make_hyperslab(g, name, is_complex, r...);
+  if (h5_impl::slice_lengths<ArrayType>(h) != A.shape())
+   TRIQS_RUNTIME_ERROR << "h5_write_slice : the slice of the dataset " << name << " and the array have different shapes";
+  auto b = make_const_cache(A).view();
+  h5_impl::write_array_slice_impl(g, name, b.data_start(), h5_impl::array_stride_info{b}, h);
+ }
+
+ /// Create a dataset for an array of T of the given shape, to be written by h5_write_slice
+ template <typename T, int R> void h5_create_array_dataset(h5::group g, std::string const& name, mini_vector<size_t, R> const& shape) {
+  h5_impl::create_array_dataset_impl<T>(g, name, R, shape.ptr());
+ }
+
 }}
 
@@ -329,6 +329,67 @@ namespace triqs { namespace arrays {
       ar & TRIQS_MAKE_NVP("indexmap",this->indexmap_);
      }
 
+    // Binary archives (cf triqs/utility/binary_archive.hpp) : the lengths, then the elements in C order.
+    // The numbers of a contiguous array in C order are copied as a single block.
+    template <class Archive> friend void binary_save(Archive &ar, indexmap_storage_pair const &a) {
+     for (int u = 0; u < rank; ++u) ar.save_size(a.indexmap().lengths()[u]);
+     value_type const *p = a.data_start();
+     if (a.is_c_contiguous() && (std::is_arithmetic<value_type>::value || triqs::is_complex<value_type>::value))
+      ar.save_bytes(p, a.domain().number_of_elements() * sizeof(value_type));
+     else
+      for_each_in_c_order(a, p, [&ar](value_type const &x) { ar << x; });
+    }
+
+    template <class Archive> friend void binary_load(Archive &ar, indexmap_storage_pair &a) {
+     constexpr bool is_number = std::is_arithmetic<value_type>::value || triqs::is_complex<value_type>::value;
+     mini_vector<size_t, rank> l;
+     std::size_t n = 1;
+     for (int u = 0; u < rank; ++u) { // the lengths are checked against the archive before the allocation
+      l[u] = ar.load_size();
+      if (is_number) ar.check_remaining(l[u], n * sizeof(value_type));
+      n *= l[u];
+     }
+     if (IsView) {
+      if (a.domain().lengths() != l) TRIQS_RUNTIME_ERROR << "binary_load : the view has the lengths " << a.domain().lengths() << " instead of " << l;
+     } else
+      a.resize(domain_type(l));
+     value_type *p = a.data_start();
+     if (a.is_c_contiguous() && is_number)
+      ar.load_bytes(p, a.domain().number_of_elements() * sizeof(value_type));
+     else
+      for_each_in_c_order(a, p, [&ar](value_type &x) { ar >> x; });
+    }
+
+    private:
+    bool is_c_contiguous() const {
+     auto const &st = indexmap().strides();
+     auto const &l = indexmap().lengths();
+     std::ptrdiff_t s = 1;
+     for (int u = rank - 1; u >= 0; --u) {
+      if ((l[u] > 1) && (st[u] != s)) return false;
+      s *= l[u];
+     }
+     return true;
+    }
+
+    // f(x) for the elements x of a, at p = a.data_start()
+    template <typename T, typename F> static void for_each_in_c_order(indexmap_storage_pair const &a, T *p, F &&f) {
+     auto const &st = a.indexmap().strides();
+     auto const &l = a.indexmap().lengths();
+     long n = a.domain().number_of_elements();
+     for (long k = 0; k < n; ++k) {
+      std::ptrdiff_t offset = 0;
+      long r = k;
+      for (int u = rank - 1; u >= 0; --u) {
+       offset += (r % l[u]) * st[u];
+       r /= l[u];
+      }
+      f(p[offset]);
+     }
+    }
+
+    protected:
+
     // pretty print of the array
     friend std::ostream & operator << (std::ostream & out, const indexmap_storage_pair & A) {
      if (A.storage().size()==0) out<<"empty ";
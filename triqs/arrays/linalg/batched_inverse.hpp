@@ -0,0 +1,200 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2011 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef TRIQS_ARRAYS_LINALG_BATCHED_INVERSE_H
+#define TRIQS_ARRAYS_LINALG_BATCHED_INVERSE_H
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "./det_and_inverse.hpp"
+
+namespace triqs {
+namespace arrays {
+
+ namespace batched_inverse_impl {
+
+  // A square matrix of a batch, given by its first element and its strides, copied in and out of a small local array.
+  // The kernels return false if the matrix is singular.
+
+  template <typename T> bool inverse_1(T *a, long, long) {
+   if (*a == T(0)) return false;
+   *a = T(1) / *a;
+   return true;
+  }
+
+  template <typename T> bool inverse_2(T *a, long s0, long s1) {
+   T a00 = a[0], a01 = a[s1], a10 = a[s0], a11 = a[s0 + s1];
+   T det = a00 * a11 - a01 * a10;
+   if (det == T(0)) return false;
+   T id = T(1) / det;
+   a[0] = a11 * id;
+   a[s1] = -a01 * id;
+   a[s0] = -a10 * id;
+   a[s0 + s1] = a00 * id;
+   return true;
+  }
+
+  template <typename T> bool inverse_3(T *a, long s0, long s1) {
+   T m[3][3];
+   for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j) m[i][j] = a[i * s0 + j * s1];
+   T c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+   T c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+   T c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+   T det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+   if (det == T(0)) return false;
+   T id = T(1) / det;
+   T r[3][3] = {{c00, m[0][2] * m[2][1] - m[0][1] * m[2][2], m[0][1] * m[1][2] - m[0][2] * m[1][1]},
+                {c01, m[0][0] * m[2][2] - m[0][2] * m[2][0], m[0][2] * m[1][0] - m[0][0] * m[1][2]},
+                {c02, m[0][1] * m[2][0] - m[0][0] * m[2][1], m[0][0] * m[1][1] - m[0][1] * m[1][0]}};
+   for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j) a[i * s0 + j * s1] = r[i][j] * id;
+   return true;
+  }
+
+  // 4x4 : expansion on the 2x2 minors of the two first and the two last rows
+  template <typename T> bool inverse_4(T *a, long s0, long s1) {
+   T m[4][4];
+   for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j) m[i][j] = a[i * s0 + j * s1];
+   T s[6] = {m[0][0] * m[1][1] - m[1][0] * m[0][1], m[0][0] * m[1][2] - m[1][0] * m[0][2], m[0][0] * m[1][3] - m[1][0] * m[0][3],
+             m[0][1] * m[1][2] - m[1][1] * m[0][2], m[0][1] * m[1][3] - m[1][1] * m[0][3], m[0][2] * m[1][3] - m[1][2] * m[0][3]};
+   T c[6] = {m[2][0] * m[3][1] - m[3][0] * m[2][1], m[2][0] * m[3][2] - m[3][0] * m[2][2], m[2][0] * m[3][3] - m[3][0] * m[2][3],
+             m[2][1] * m[3][2] - m[3][1] * m[2][2], m[2][1] * m[3][3] - m[3][1] * m[2][3], m[2][2] * m[3][3] - m[3][2] * m[2][3]};
+   T det = s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+   if (det == T(0)) return false;
+   T id = T(1) / det;
+   T r[4][4] = {{m[1][1] * c[5] - m[1][2] * c[4] + m[1][3] * c[3], -m[0][1] * c[5] + m[0][2] * c[4] - m[0][3] * c[3],
+                 m[3][1] * s[5] - m[3][2] * s[4] + m[3][3] * s[3], -m[2][1] * s[5] + m[2][2] * s[4] - m[2][3] * s[3]},
+                {-m[1][0] * c[5] + m[1][2] * c[2] - m[1][3] * c[1], m[0][0] * c[5] - m[0][2] * c[2] + m[0][3] * c[1],
+                 -m[3][0] * s[5] + m[3][2] * s[2] - m[3][3] * s[1], m[2][0] * s[5] - m[2][2] * s[2] + m[2][3] * s[1]},
+                {m[1][0] * c[4] - m[1][1] * c[2] + m[1][3] * c[0], -m[0][0] * c[4] + m[0][1] * c[2] - m[0][3] * c[0],
+                 m[3][0] * s[4] - m[3][1] * s[2] + m[3][3] * s[0], -m[2][0] * s[4] + m[2][1] * s[2] - m[2][3] * s[0]},
+                {-m[1][0] * c[3] + m[1][1] * c[1] - m[1][2] * c[0], m[0][0] * c[3] - m[0][1] * c[1] + m[0][2] * c[0],
+                 -m[3][0] * s[3] + m[3][1] * s[1] - m[3][2] * s[0], m[2][0] * s[3] - m[2][1] * s[1] + m[2][2] * s[0]}};
+   for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j) a[i * s0 + j * s1] = r[i][j] * id;
+   return true;
+  }
+
+  // General size : LU (getrf/getri) in a workspace allocated once per thread
+  template <typename T> struct lu_workspace {
+   int n, lwork;
+   std::vector<T> buf, work;
+   std::vector<int> ipiv;
+   lu_workspace(int n) : n(n), lwork(64 * n), buf(n * n), work(lwork), ipiv(n) {}
+
+   bool operator()(T *a, long s0, long s1) {
+    for (int i = 0; i < n; ++i) // Fortran order
+     for (int j = 0; j < n; ++j) buf[i + j * n] = a[i * s0 + j * s1];
+    int info;
+    lapack::f77::getrf(n, n, buf.data(), n, ipiv.data(), info);
+    if (info != 0) return false;
+    lapack::f77::getri(n, buf.data(), n, ipiv.data(), work.data(), lwork, info);
+    if (info != 0) return false;
+    for (int i = 0; i < n; ++i)
+     for (int j = 0; j < n; ++j) a[i * s0 + j * s1] = buf[i + j * n];
+    return true;
+   }
+  };
+
+  struct no_fill {
+   template <typename T> void operator()(long, T *, long, long) const {}
+  };
+
+  template <typename T, typename Fill, typename Inv>
+  bool _fill_and_invert(T *start, long first, long last, long stride, long s0, long s1, Fill &fill, Inv &&inv) {
+   bool ok = true;
+   for (long i = first; i < last; ++i) {
+    fill(i, start + i * stride, s0, s1);
+    ok = inv(start + i * stride, s0, s1) && ok;
+   }
+   return ok;
+  }
+
+  /// Fill, then invert in place, the n x n matrices i in [first, last) of a batch. Serial.
+  /**
+   * @param start Pointer to the first element of the batch
+   * @param stride, s0, s1 Strides of the batch, of the rows and of the columns
+   * @param fill Called as fill(i, p, s0, s1) to set the matrix at p before its inversion
+   * @return false if one of the matrices is singular
+   */
+  template <typename T, typename Fill>
+  bool fill_and_invert(T *start, long first, long last, long stride, long n, long s0, long s1, Fill &&fill) {
+   switch (n) {
+    case 1: return _fill_and_invert(start, first, last, stride, s0, s1, fill, inverse_1<T>);
+    case 2: return _fill_and_invert(start, first, last, stride, s0, s1, fill, inverse_2<T>);
+    case 3: return _fill_and_invert(start, first, last, stride, s0, s1, fill, inverse_3<T>);
+    case 4: return _fill_and_invert(start, first, last, stride, s0, s1, fill, inverse_4<T>);
+    default: return _fill_and_invert(start, first, last, stride, s0, s1, fill, lu_workspace<T>(n));
+   }
+  }
+
+  inline void throw_singular(std::string const &fname) {
+   matrix_inverse_exception e;
+   e << fname << " : matrix is not invertible";
+   throw e;
+  }
+ }
+
+ /// Fill, then invert in place, each matrix a(i,_,_) of a rank 3 array (or view)
+ /**
+  * The matrices are processed in parallel (OpenMP), each thread working on a contiguous slice of the batch.
+  * The sizes 1 to 4 use closed formulas, the larger ones an LU decomposition in a workspace allocated once per thread.
+  * Throws matrix_inverse_exception if one of the matrices is singular.
+  * @param fill Called as fill(i, p, s0, s1) where p points to a(i,0,0), s0 and s1 are the row and column strides.
+  */
+ template <typename A3, typename Fill> void batched_fill_and_inverse_in_place(A3 &&a, Fill &&fill) {
+  using T = typename std14::decay_t<A3>::value_type;
+  static_assert(std14::decay_t<A3>::rank == 3, "batched_inverse_in_place : the array must have rank 3");
+  if (second_dim(a) != third_dim(a))
+   TRIQS_RUNTIME_ERROR << "batched_inverse_in_place : the matrices are not square but of size " << second_dim(a) << " x "
+                       << third_dim(a);
+  long n_mat = first_dim(a), n = second_dim(a);
+  if (n_mat == 0 || n == 0) return;
+  auto const &st = a.indexmap().strides();
+  T *start = a.data_start();
+  bool singular = false;
+#pragma omp parallel reduction(|| : singular) if (n_mat > 16)
+  {
+   long first = 0, last = n_mat;
+#ifdef _OPENMP
+   long n_threads = omp_get_num_threads(), rank = omp_get_thread_num();
+   first = (n_mat * rank) / n_threads;
+   last = (n_mat * (rank + 1)) / n_threads;
+#endif
+   singular = !batched_inverse_impl::fill_and_invert(start, first, last, st[0], n, st[1], st[2], fill);
+  }
+  if (singular) batched_inverse_impl::throw_singular("batched_inverse_in_place");
+ }
+
+ /// Invert in place each matrix a(i,_,_) of a rank 3 array (or view)
+ /**
+  * The matrices are processed in parallel (OpenMP). The sizes 1 to 4 use closed formulas,
+  * the larger ones an LU decomposition in a workspace allocated once per thread.
+  * Throws matrix_inverse_exception if one of the matrices is singular.
+  */
+ template <typename A3> void batched_inverse_in_place(A3 &&a) {
+  batched_fill_and_inverse_in_place(std::forward<A3>(a), batched_inverse_impl::no_fill{});
+ }
+}
+}
+#endif
@@ -34,6 +34,7 @@ typedef void PyObject;
 
 #include "./memcopy.hpp"
 #include <triqs/utility/macros.hpp>
+#include <memory>
 
 //#define TRIQS_ARRAYS_DEBUG_TRACE_MEM
 #ifdef TRIQS_ARRAYS_DEBUG_TRACE_MEM
@@ -105,6 +106,7 @@ namespace triqs { namespace arrays { namespace storages { //namespace details {
   *
   *   - allocated (and deleted in C++)
   *   - owned by a numpy python object (py_numpy)
+  *   - owned by a foreign C++ object (e.g. a memory mapping of a file)
   *
   *  The block contains its own reference system, to avoid the use of shared_ptr in shared_block
   *  (which was very slow in critical codes).
@@ -134,6 +136,10 @@ namespace triqs { namespace arrays { namespace storages { //namespace details {
   *       * when python is done with this numpy, hence the guard, the c++ reference is dec_refed and
   *         the usage can continue normally in c++ (without *any* python ref contrary to a previous design).
   *
+  *  * State 4) : p !=nullptr && foreign_owner != nullptr && py_numpy == nullptr && py_guard == nullptr
+  *    Memory block owned by a foreign object, e.g. a memory mapping of a file (cf h5_read_mapped).
+  *    The block keeps a reference to its owner, which is released at destruction.
+  *
   *  * Invariants :
   *    * py_numpy == nullptr || py_guard == nullptr :
   *    * ref_count >=1.
@@ -146,6 +152,7 @@ namespace triqs { namespace arrays { namespace storages { //namespace details {
   size_t weak_ref_count;              // number of refs. :  >=1
   PyObject * py_numpy;           // if not null, an owned reference to a numpy which is the data of this block
   PyObject * py_guard;           // if not null, a BORROWED reference to the guard. If null, the guard does not exist
+  std::shared_ptr<void> foreign_owner; // if not null, the owner of p (state 4)
   static_assert(!std::is_const<ValueType>::value, "internal error");
 
 #ifdef TRIQS_WITH_PYTHON_SUPPORT
@@ -165,6 +172,10 @@ namespace triqs { namespace arrays { namespace storages { //namespace details {
    weak_ref_count =0;
   }
 
+  // construct to state 4 : the memory p is kept alive by owner
+  mem_block(ValueType *p, size_t s, std::shared_ptr<void> owner)
+     : size_(s), p(p), ref_count(1), weak_ref_count(0), py_numpy(nullptr), py_guard(nullptr), foreign_owner(std::move(owner)) {}
+
 #ifdef TRIQS_WITH_PYTHON_SUPPORT
   // construct to state 2. python_object_is_borrowed : whether the python ref is borrowed
   mem_block (PyObject * obj, bool python_object_is_borrowed) {
@@ -188,7 +199,8 @@ namespace triqs { namespace arrays { namespace storages { //namespace details {
    assert(ref_count<=1); assert(py_guard==nullptr);// state 3 forbidden
    if (py_numpy)
     Py_DECREF(py_numpy); // state 1
-   else {
+   else if (foreign_owner) { // state 4 : the owner is released with this
+   } else {
     if (p) { // state 2 or state 0
      TRACE_MEM_DEBUG("Desallocating from C++ a block of size " << this->size_ << " at address " << p);
      TRIQS_MEMORY_USED_INC(-size_);
@@ -202,6 +214,7 @@ namespace triqs { namespace arrays { namespace storages { //namespace details {
   mem_block & operator=(mem_block && X) = delete;
   mem_block(mem_block && X) noexcept {
    size_ = X.size_; p = X.p; ref_count = X.ref_count; weak_ref_count = X.weak_ref_count; py_numpy=X.py_numpy; py_guard = X.py_guard;
+   foreign_owner = std::move(X.foreign_owner);
    X.p =nullptr; X.py_numpy= nullptr; X.py_guard = nullptr; // state 0, ready to destruct
   }
 
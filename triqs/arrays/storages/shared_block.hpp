@@ -60,6 +60,10 @@ namespace triqs { namespace arrays { namespace storages {
    explicit shared_block(PyObject * arr, bool weak): sptr(new mem_block<ValueType>(arr,weak)) { data_ = sptr->p; s= sptr->size(); }
 #endif
 
+   /// Share a block of memory owned by a foreign object, which is kept alive as long as the block is used
+   shared_block(ValueType *p, size_t size, std::shared_ptr<void> owner)
+      : sptr(new mem_block<ValueType>(p, size, std::move(owner))), data_(p), s(size) {}
+
    explicit shared_block() { sptr =nullptr; data_=nullptr; s=0; }
 
    shared_block(shared_block const & X) noexcept { sptr =X.sptr; data_ = X.data_; s= X.s; if (sptr) inc_ref<Weak>(sptr);  }
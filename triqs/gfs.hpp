@@ -46,6 +46,10 @@
 #endif
 #include <triqs/gfs/impl/map.hpp>
 #include <triqs/gfs/impl/block_gf_iterator.hpp>
+#include <triqs/gfs/functions/dyson.hpp>
+#include <triqs/gfs/functions/evaluate_many.hpp>
+#include <triqs/gfs/functions/imtime_spline.hpp>
+#include <triqs/gfs/functions/h5_distributed.hpp>
 
 #include <triqs/gfs/transform/fourier_matsubara.hpp>
 #include <triqs/gfs/transform/fourier_real.hpp>
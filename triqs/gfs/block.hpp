@@ -22,6 +22,7 @@
 #include "./gf_classes.hpp"
 #include "./meshes/discrete.hpp"
 #include <iterator>
+#include <exception>
 
 namespace triqs {
 namespace gfs {
@@ -61,12 +62,39 @@ namespace gfs {
  template <typename G>
  struct is_block_gf_or_view<G, 0> : std::integral_constant<bool, is_block_gf_or_view<G, 1>::value> {};
 #endif
+
+ /// ---------------------------  parallel execution on the blocks ---------------------------------
+
+ /// Execution policy of the functions applied block by block
+ enum class block_execution { serial, parallel };
+
+ /// Calls f(i) for each block i in [0, n)
+ /**
+  * In parallel, the blocks are distributed among the threads (OpenMP) one by one with a dynamic schedule,
+  * as their sizes may be very different. Parallel regions inside f are then executed by a single thread.
+  * The first exception thrown by f is rethrown, once all the blocks are done.
+  */
+ template <typename F> void for_each_block(long n, F &&f, block_execution policy = block_execution::parallel) {
+  std::exception_ptr eptr;
+#pragma omp parallel for schedule(dynamic, 1) if ((policy == block_execution::parallel) && (n > 1))
+  for (long i = 0; i < n; ++i) {
+   try {
+    f(i);
+   } catch (...) {
+#pragma omp critical(triqs_gfs_for_each_block)
+    if (!eptr) eptr = std::current_exception();
+   }
+  }
+  if (eptr) std::rethrow_exception(eptr);
+ }
+
  /// ---------------------------  hdf5 ---------------------------------
 
  template <typename Target> struct gf_h5_name<block_index, Target, nothing> {
   static std::string invoke() { return "BlockGf"; }
  };
 
+ // The blocks are read and written one after the other : the HDF5 library is in general not thread safe.
  template <typename Target> struct gf_h5_rw<block_index, Target, nothing, void> {
 
   static void write(h5::group gr, gf_const_view<block_index, Target> g) {
@@ -201,6 +229,17 @@ namespace gfs {
   return {std::move(m), std::move(V), nothing{}, nothing{}, nothing{}};
  }
 
+ // -------------------------------   Assignment   --------------------------------------------------
+
+ // Each block is assigned independently, in parallel
+ template <typename T, typename S, typename E, typename RHS>
+ std14::enable_if_t<!arrays::is_scalar<RHS>::value> triqs_gf_view_assign_delegation(gf_view<block_index, T, S, E> g, RHS const &rhs) {
+  if (!(g.mesh() == rhs.mesh()))
+   TRIQS_RUNTIME_ERROR << "Gf Assignment in View : incompatible mesh" << g.mesh() << " vs " << rhs.mesh();
+  auto const &m = g.mesh();
+  for_each_block(m.size(), [&](long i) { g[m[i]] = rhs[m[i]]; });
+ }
+
  // -------------------------------   Free functions   --------------------------------------------------
 
  /// The number of blocks
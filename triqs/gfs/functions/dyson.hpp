@@ -0,0 +1,160 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2015 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "../imfreq.hpp"
+#include "../block.hpp"
+#include <triqs/arrays/linalg/batched_inverse.hpp>
+#include <array>
+
+namespace triqs {
+namespace gfs {
+
+ namespace dyson_impl {
+
+  // The matrix (i omega_n + mu - eps - sigma(i omega_n)) at the linear index i of the mesh, written in place.
+  // sigma may alias the result : each element of sigma is read before the same element of the result is written.
+  template <typename T> struct fill_bracket {
+   gf_mesh<imfreq> mesh;
+   dcomplex mu;
+   arrays::matrix<T> const &eps;
+   dcomplex const *sigma;
+   long ss0, ss1, ss2;
+
+   void operator()(long i, dcomplex *m, long s0, long s1) const {
+    dcomplex iw_mu = mesh.index_to_point(mesh.linear_to_index(i)) + mu;
+    dcomplex const *sig = sigma + i * ss0;
+    long n = first_dim(eps);
+    for (long a = 0; a < n; ++a)
+     for (long b = 0; b < n; ++b) m[a * s0 + b * s1] = (a == b ? iw_mu : 0) - eps(a, b) - sig[a * ss1 + b * ss2];
+   }
+  };
+
+  template <typename G, typename T, typename Sigma> void check(G const &g, arrays::matrix<T> const &eps, Sigma const &sigma) {
+   if (g.mesh() != sigma.mesh()) TRIQS_RUNTIME_ERROR << "dyson : g and sigma do not have the same mesh";
+   auto sh = g.data().shape(), sh_s = sigma.data().shape();
+   if ((sh[1] != sh[2]) || (sh[1] != sh_s[1]) || (sh[2] != sh_s[2]) || (first_dim(eps) != sh[1]) || (second_dim(eps) != sh[1]))
+    TRIQS_RUNTIME_ERROR << "dyson : size mismatch between g " << sh << ", sigma " << sh_s << " and eps " << eps.shape();
+  }
+
+  // Tail of the result, computed before the data, as sigma may be g itself.
+  template <typename T, typename Sigma> tail dyson_tail(dcomplex mu, arrays::matrix<T> const &eps, Sigma const &sigma) {
+   auto const &ts = sigma.singularity();
+   arrays::matrix<dcomplex> mu_eps = mu * arrays::make_unit_matrix<dcomplex>(first_dim(eps)) - eps;
+   return inverse(tail_omega(ts.shape(), ts.size(), ts.order_min()) - ts + mu_eps);
+  }
+
+  template <typename G, typename T, typename Sigma>
+  fill_bracket<T> make_fill(G const &g, dcomplex mu, arrays::matrix<T> const &eps, Sigma const &sigma) {
+   auto const &st = sigma.data().indexmap().strides();
+   return {g.mesh(), mu, eps, sigma.data().data_start(), st[0], st[1], st[2]};
+  }
+ }
+
+ /// Solve the Dyson equation $G(i\omega_n) = (i\omega_n + \mu - \epsilon - \Sigma(i\omega_n))^{-1}$ in a single pass
+ /**
+  * The bracket is computed and inverted in place, mesh point by mesh point, in parallel (OpenMP), without temporary gf.
+  * The tail of g is the inverse of the tail of the bracket.
+  * @param g The result. It may be sigma itself.
+  * @param mu Chemical potential
+  * @param eps Matrix of the quadratic part of the Hamiltonian
+  * @param sigma Self-energy, on the same mesh as g
+  */
+ template <typename T, typename S, typename E>
+ void dyson(gf_view<imfreq, matrix_valued, S, E> g, dcomplex mu, arrays::matrix<T> const &eps,
+            gf_const_view<imfreq, matrix_valued, S, E> sigma) {
+  dyson_impl::check(g, eps, sigma);
+  auto t = dyson_impl::dyson_tail(mu, eps, sigma);
+  arrays::batched_fill_and_inverse_in_place(g.data(), dyson_impl::make_fill(g, mu, eps, sigma));
+  g.singularity() = t;
+ }
+
+ template <typename T, typename S, typename E>
+ void dyson(gf_view<imfreq, matrix_valued, S, E> g, dcomplex mu, arrays::matrix<T> const &eps,
+            gf_view<imfreq, matrix_valued, S, E> sigma) {
+  dyson(g, mu, eps, make_const_view(sigma));
+ }
+
+ template <typename T, typename S, typename E>
+ void dyson(gf<imfreq, matrix_valued, S, E> &g, dcomplex mu, arrays::matrix<T> const &eps,
+            gf<imfreq, matrix_valued, S, E> const &sigma) {
+  dyson(g(), mu, eps, sigma());
+ }
+
+ /// Solve the Dyson equation for each block, $G_b = (i\omega_n + \mu - \epsilon_b - \Sigma_b)^{-1}$
+ /**
+  * All the (block, mesh point) pairs are distributed among the threads (OpenMP, dynamic schedule),
+  * hence the blocks of different sizes are balanced.
+  * @param g The result. It may be sigma itself.
+  * @param mu Chemical potential
+  * @param eps Matrices of the quadratic part of the Hamiltonian, one per block
+  * @param sigma Self-energy, with the same blocks and meshes as g
+  */
+ template <typename T>
+ void dyson(block_gf_view<imfreq> g, dcomplex mu, std::vector<arrays::matrix<T>> const &eps, block_gf_const_view<imfreq> sigma) {
+  long n_bl = n_blocks(g);
+  if ((n_bl != n_blocks(sigma)) || (n_bl != long(eps.size())))
+   TRIQS_RUNTIME_ERROR << "dyson : number of blocks mismatch between g, sigma and eps";
+  std::vector<tail> tails;
+  std::vector<dyson_impl::fill_bracket<T>> fills;
+  std::vector<dcomplex *> starts;
+  std::vector<std::array<long, 4>> dims; // size of the matrices, strides of the data
+  for (long b = 0; b < n_bl; ++b) {
+   dyson_impl::check(g[b], eps[b], sigma[b]);
+   tails.push_back(dyson_impl::dyson_tail(mu, eps[b], sigma[b]));
+   fills.push_back(dyson_impl::make_fill(g[b], mu, eps[b], sigma[b]));
+   auto d = g[b].data();
+   auto const &st = d.indexmap().strides();
+   dcomplex *start = d.data_start();
+   starts.push_back(start);
+   dims.push_back({{long(first_dim(eps[b])), st[0], st[1], st[2]}});
+  }
+
+  // work items : chunks of mesh points of each block
+  const long chunk = 64;
+  std::vector<std::array<long, 3>> items; // block, first, last
+  for (long b = 0; b < n_bl; ++b) {
+   long n_mat = first_dim(g[b].data());
+   for (long i = 0; i < n_mat; i += chunk) items.push_back({{b, i, std::min(i + chunk, n_mat)}});
+  }
+
+  bool singular = false;
+#pragma omp parallel for schedule(dynamic) reduction(|| : singular)
+  for (long k = 0; k < long(items.size()); ++k) {
+   long b = items[k][0];
+   auto const &d = dims[b];
+   singular = !arrays::batched_inverse_impl::fill_and_invert(starts[b], items[k][1], items[k][2], d[1], d[0], d[2], d[3], fills[b]) ||
+              singular;
+  }
+  if (singular) arrays::batched_inverse_impl::throw_singular("dyson");
+  for (long b = 0; b < n_bl; ++b) g[b].singularity() = tails[b];
+ }
+
+ template <typename T>
+ void dyson(block_gf_view<imfreq> g, dcomplex mu, std::vector<arrays::matrix<T>> const &eps, block_gf_view<imfreq> sigma) {
+  dyson(g, mu, eps, make_const_view(sigma));
+ }
+
+ template <typename T>
+ void dyson(block_gf<imfreq> &g, dcomplex mu, std::vector<arrays::matrix<T>> const &eps, block_gf<imfreq> const &sigma) {
+  dyson(g(), mu, eps, sigma());
+ }
+}
+}
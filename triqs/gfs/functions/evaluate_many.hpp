@@ -0,0 +1,87 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2015 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "../imtime.hpp"
+#include "../retime.hpp"
+#include "../refreq.hpp"
+
+namespace triqs {
+namespace gfs {
+
+ /// Evaluate a one variable gf at many points at once : out(k, ...) = g(xs(k))
+ /**
+  * The indices and the weights of the interpolation of all the points are first computed by the mesh, in a vectorized loop.
+  * The data is then gathered point by point, each point reading a few rows of the data.
+  * For the meshes imtime (with the (anti)periodicity in tau), retime and refreq.
+  * Throws if one of the points is out of the mesh.
+  * @param g The gf
+  * @param xs The points
+  * @param out The result. Its first dimension is the number of points, the others are the target shape of g.
+  * @param policy interpol_t::Linear1d (default, as g(x)) or interpol_t::Cubic1d
+  */
+ template <typename G, typename Out, typename Policy = interpol_t::Linear1d>
+ std14::enable_if_t<is_gf_or_view<G>::value && arrays::is_amv_value_or_view_class<std14::decay_t<Out>>::value>
+ evaluate_many(G const &g, arrays::array_const_view<double, 1> xs, Out &&out, Policy policy = {}) {
+  using T = typename std14::decay_t<decltype(g.data())>::value_type;
+  using U = typename std14::decay_t<Out>::value_type;
+  static_assert(std14::decay_t<Out>::rank == std14::decay_t<decltype(g.data())>::rank,
+                "evaluate_many : the result must have the rank of the data of the gf");
+  long n = first_dim(xs);
+  auto sh = g.data().shape(), sh_out = out.shape();
+  bool same_shape = (long(sh_out[0]) == n);
+  for (int r = 1; r < int(sh.size()); ++r) same_shape = same_shape && (sh[r] == sh_out[r]);
+  if (!same_shape) TRIQS_RUNTIME_ERROR << "evaluate_many : the result has the shape " << sh_out << " for " << n << " points and a data of shape " << sh;
+
+  constexpr int m = std14::decay_t<decltype(g.mesh())>::interpolation_stencil(Policy{});
+  std::vector<double> x(xs.begin(), xs.end()), w(n * m);
+  std::vector<long> idx(n * m);
+  g.mesh().get_interpolation_data(policy, x.data(), n, idx.data(), w.data());
+
+  auto d = details::make_flat_data<const T>(g.data());
+  auto r = details::make_flat_data<U>(out);
+  long nc = d.n_components();
+  for (long k = 0; k < n; ++k) {
+   const T *rows[m];
+   for (int q = 0; q < m; ++q) rows[q] = d.start + idx[k * m + q] * d.stride;
+   double const *wk = w.data() + k * m;
+   for (long c = 0; c < nc; ++c) {
+    long o = d.offsets[c];
+    U s = wk[0] * rows[0][o];
+    for (int q = 1; q < m; ++q) s += wk[q] * rows[q][o];
+    r(k, c) = s;
+   }
+  }
+ }
+
+ /// Same as above, the result is returned as an array
+ template <typename G, typename Policy = interpol_t::Linear1d>
+ std14::enable_if_t<is_gf_or_view<G>::value && !arrays::is_amv_value_or_view_class<Policy>::value,
+                    arrays::array<typename std14::decay_t<decltype(std::declval<G>().data())>::value_type,
+                                  std14::decay_t<decltype(std::declval<G>().data())>::rank>>
+ evaluate_many(G const &g, arrays::array_const_view<double, 1> xs, Policy policy = {}) {
+  auto sh = g.data().shape();
+  sh[0] = first_dim(xs);
+  arrays::array<typename std14::decay_t<decltype(g.data())>::value_type, std14::decay_t<decltype(g.data())>::rank> res(sh);
+  evaluate_many(g, xs, res, policy);
+  return res;
+ }
+}
+}
@@ -2,6 +2,52 @@
 
 namespace triqs { namespace gfs {
 
+ namespace {
+
+  using details::flat_data;
+  using details::make_flat_data;
+  using details::tail_coefs;
+
+  // Fit of the moments 1, 2, 3 of the tails of all the columns of g at once, the moments -1 and 0 being 0,
+  // on the last quarter of the positive frequencies.
+  // The moments are complex : with omega = omega_n, g = a_1/(i omega) + a_2/(i omega)^2 + a_3/(i omega)^3 gives
+  //   Re g = Im(a_1)/omega - Re(a_2)/omega^2 - Im(a_3)/omega^3,  Im g = -Re(a_1)/omega - Im(a_2)/omega^2 + Re(a_3)/omega^3.
+  // The design matrix (1/omega, 1/omega^2, 1/omega^3) is the same for the real and imaginary parts of all the columns :
+  // a single least square problem, with 2 right hand sides per column.
+  tail_coefs fit_tails_of_columns(flat_data<const dcomplex> const &g, gf_mesh<imfreq> const &m) {
+   long n = g.n_components();
+   int n_max = m.last_index();
+   int n_min = std::max(int(0.75 * (n_max + 1)), int(m.first_index()));
+   int size1 = n_max - n_min + 1;
+   if (size1 < 3) TRIQS_RUNTIME_ERROR << "inverse_fourier : not enough frequencies to fit the tails";
+
+   arrays::matrix<double> A(size1, 3, FORTRAN_LAYOUT), B(size1, 2 * n, FORTRAN_LAYOUT);
+   for (int k = 0; k < size1; ++k) {
+    double omega = imag(dcomplex(m.index_to_point(n_min + k)));
+    long i = m.index_to_linear(n_min + k);
+    for (int l = 0; l < 3; ++l) A(k, l) = std::pow(omega, -(l + 1));
+    for (long c = 0; c < n; ++c) {
+     B(k, c) = real(g(i, c));
+     B(k, n + c) = imag(g(i, c));
+    }
+   }
+   arrays::vector<double> S(3);
+   const double rcond = 0.0;
+   int rank;
+   arrays::lapack::gelss(A, B, S, rcond, rank);
+
+   tail_coefs tc(n);
+   for (long c = 0; c < n; ++c) {
+    tc.d[c] = dcomplex(-B(0, n + c), B(0, c));
+    tc.A[c] = dcomplex(-B(1, c), -B(1, n + c));
+    tc.B[c] = dcomplex(B(2, n + c), -B(2, c));
+   }
+   return tc;
+  }
+ }
+
+ // Each step transforms one variable, for all the values of the other one and all the components at once (one batched FFT),
+ // directly from the data of the source to the data of the result.
 
  gf<cartesian_product<imfreq, imfreq>, tensor_valued<3>> fourier(gf_const_view<cartesian_product<imtime, imtime>, tensor_valued<3>> g2t,  int n_w_1,  int n_w_2, bool positive_matsub_only_1, bool positive_matsub_only_2){
 
@@ -12,30 +58,15 @@ namespace triqs { namespace gfs {
   gf<cartesian_product<imfreq, imfreq>, tensor_valued<3>> g2w({imfreq_mesh_1, imfreq_mesh_2}, get_target_shape(g2t));
   gf<cartesian_product<imfreq, imtime>, tensor_valued<3>> gwt({imfreq_mesh_1, std::get<1>(g2t.mesh().components())}, get_target_shape(g2t));
 
-  // long (explicit) version 
-  auto g_t_tp = triqs::make_view(curry<1>(g2t));
-  array<tail,3> tail_3(get_target_shape(g2t));
-  tail t(1,1);tail_3()=t;
-  for(auto const & tau : g_t_tp.mesh()){
-   auto g_w_tp_tau = fourier(g_t_tp[tau], tail_3, n_w_1, positive_matsub_only_1);
-   for(auto const & om: std::get<0>(gwt.mesh().components()))
-    gwt[{om, tau}] = g_w_tp_tau[om];
-  }
-
-  auto g_w_tp = triqs::make_view(curry<0>(gwt));
-  for(auto const & om : g_w_tp.mesh()){
-   auto g_w_wp_nu = fourier(g_w_tp[om], tail_3, n_w_2, positive_matsub_only_2);
-   for(auto const & nu: std::get<1>(g2w.mesh().components()))
-    g2w[{om, nu}] = g_w_wp_nu[nu];
-  }
-  /* short version : (does not compile)
-  clef::placeholder<0> tau_;
-  curry<1>(gwt)[tau_] << fourier(curry<1>(g2t)[tau_]);
-  clef::placeholder<1> om_;
-  curry<0>(g2w)[om_] << fourier(curry<0>(gwt)[om_]);
-  */
-  
+  // tau -> i omega, without tail
+  auto f_2t = make_flat_data<const dcomplex>(g2t.data(), 0);
+  details::fourier_matsubara_direct(make_flat_data<dcomplex>(gwt.data(), 0), imfreq_mesh_1, f_2t, std::get<0>(g2t.mesh().components()),
+                                    tail_coefs(f_2t.n_components()));
 
+  // tau' -> i Omega
+  auto f_wt = make_flat_data<const dcomplex>(gwt.data(), 1);
+  details::fourier_matsubara_direct(make_flat_data<dcomplex>(g2w.data(), 1), imfreq_mesh_2, f_wt, std::get<1>(g2t.mesh().components()),
+                                    tail_coefs(f_wt.n_components()));
   return g2w;
  }
 
@@ -48,38 +79,18 @@ namespace triqs { namespace gfs {
   gf<cartesian_product<imtime, imtime>, tensor_valued<3>> g2t({imtime_mesh_1, imtime_mesh_2}, get_target_shape(g2w));
   gf<cartesian_product<imtime, imfreq>, tensor_valued<3>> gtw({imtime_mesh_1, std::get<1>(g2w.mesh().components())}, get_target_shape(g2w));
 
-  array<triqs::gfs::tail,3> known_moments(get_target_shape(g2w));
-  triqs::gfs::tail t(1,1, 2, -1); 
-  t(-1)()=0.; 
-  t(0)()=0.; 
-  known_moments()=t;
-
-  array<tail,3> tail_zero(get_target_shape(g2w));
-  tail t0(1,1);tail_zero()=t0;
-
-  auto g_w_wp = triqs::make_view(curry<1>(g2w));
-
-  for(auto const & nu : g_w_wp.mesh()){
-   int n_max = g_w_wp[nu].mesh().size();
-   auto tail_3 = fit_tails ? fit_tail(g_w_wp[nu], known_moments, 3, int(0.75*n_max), n_max) : tail_zero;
-   //std::cout << tail_3(0,0,0) << endl;
-   auto g_t_wp_nu = inverse_fourier(g_w_wp[nu], tail_3, imtime_mesh_1.size());
-   for(auto const & tau: std::get<0>(gtw.mesh().components()))
-    gtw[{tau, nu}] = g_t_wp_nu[tau];
-  }
-
-  auto g_t_wp = triqs::make_view(curry<0>(gtw));
-
-  for(auto const & tau : g_t_wp.mesh()){
-   int n_max = g_t_wp[tau].mesh().size();
-   auto tail_3 = fit_tails ? fit_tail(make_const_view(g_t_wp[tau]), known_moments, 3, int(0.75*n_max), n_max) : tail_zero;
-   auto g_t_tp_tau = inverse_fourier(g_t_wp[tau], tail_3, imtime_mesh_2.size());
-   for(auto const & tp: std::get<1>(g2t.mesh().components()))
-    g2t[{tau, tp}] = g_t_tp_tau[tp];
-  }
-
+  // i omega -> tau
+  auto const &imfreq_mesh_1 = std::get<0>(g2w.mesh().components());
+  auto f_2w = make_flat_data<const dcomplex>(g2w.data(), 0);
+  details::fourier_matsubara_inverse(make_flat_data<dcomplex>(gtw.data(), 0), imtime_mesh_1, f_2w, imfreq_mesh_1,
+                                     fit_tails ? fit_tails_of_columns(f_2w, imfreq_mesh_1) : tail_coefs(f_2w.n_components()));
+
+  // i Omega -> tau'
+  auto const &imfreq_mesh_2 = std::get<1>(g2w.mesh().components());
+  auto f_tw = make_flat_data<const dcomplex>(gtw.data(), 1);
+  details::fourier_matsubara_inverse(make_flat_data<dcomplex>(g2t.data(), 1), imtime_mesh_2, f_tw, imfreq_mesh_2,
+                                     fit_tails ? fit_tails_of_columns(f_tw, imfreq_mesh_2) : tail_coefs(f_tw.n_components()));
   return g2t;
-
  }
 
 }}
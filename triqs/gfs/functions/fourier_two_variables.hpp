@@ -34,8 +34,8 @@ namespace triqs { namespace gfs {
    @param g2w $g_{uvw}(i\omega,i\Omega)$
    @param n_t_1 number of imaginary time points 
    @param n_t_2 number of imaginary time points 
+   @param fit_tails if true, the tails (moments 1 to 3) are fitted on the last quarter of the positive frequencies, otherwise they are 0
    @return $g_{uvw}(i\tau,i\tau')$
-@warning fitting the tails!
   */
  gf<cartesian_product<imtime, imtime>, tensor_valued<3>> inverse_fourier(gf_const_view<cartesian_product<imfreq, imfreq>, tensor_valued<3>> g2w,  int n_t_1,  int n_t_2, bool fit_tails=false);
 
@@ -0,0 +1,63 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2016 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "../gf_classes.hpp"
+#include <triqs/arrays/h5/distributed.hpp>
+
+namespace triqs {
+namespace gfs {
+
+ /// Write a gf distributed over the nodes of c (e.g. by mpi_scatter) into the subgroup subgroup_name of g. Collective.
+ /**
+  * The data is written by arrays::h5_write_distributed, each node writing its part of the mesh.
+  * The full mesh (mpi_gather of the local meshes), the singularity, the symmetry and the indices, the same on all nodes,
+  * are written by the root only with a serial HDF5 library, by all nodes with MPI-IO (where the creation of objects is collective).
+  * The result is read by h5_read as a gf written by h5_write. The data is always complex, without the compression
+  * of h5_write (e.g. the positive frequencies only for a real gf in imaginary time).
+  */
+ template <typename M, typename T, typename S, typename E>
+ void h5_write_distributed(h5::group g, std::string const &subgroup_name, gf_const_view<M, T, S, E> gl, mpi::communicator c = {},
+                           int root = 0) {
+  bool writer = g.is_parallel() || (c.rank() == root);
+  h5::group gr = (writer ? g.create_group(subgroup_name) : h5::group{});
+  if (writer) {
+   gr.write_triqs_hdf5_data_scheme(gl);
+   gf_h5_rw_singularity<S>::write(gr, gl);
+   h5_write(gr, "mesh", mpi_gather(gl.mesh(), c, root));
+   h5_write(gr, "symmetry", gl.symmetry());
+   h5_write(gr, "indices", gl.indices());
+  }
+  arrays::h5_write_distributed(gr, "data", gl.data(), c, root);
+ }
+
+ template <typename M, typename T, typename S, typename E>
+ void h5_write_distributed(h5::group g, std::string const &subgroup_name, gf_view<M, T, S, E> gl, mpi::communicator c = {},
+                           int root = 0) {
+  h5_write_distributed(g, subgroup_name, make_const_view(gl), c, root);
+ }
+
+ template <typename M, typename T, typename S, typename E>
+ void h5_write_distributed(h5::group g, std::string const &subgroup_name, gf<M, T, S, E> const &gl, mpi::communicator c = {},
+                           int root = 0) {
+  h5_write_distributed(g, subgroup_name, gl(), c, root);
+ }
+}
+}
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2015 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "../imtime.hpp"
+
+namespace triqs {
+namespace gfs {
+
+ /// Cubic spline interpolation of a scalar or matrix valued gf in imaginary time
+ /**
+  * The spline is clamped, with the derivatives at 0 and beta estimated by one sided finite differences.
+  * Its coefficients are stored interval by interval : for each interval, the coefficients of the power 0, 1, 2, 3
+  * of (tau - tau_i) are each a contiguous array over the components of the target, in C order.
+  * Like g(tau), the evaluation reduces tau to [0,beta], with a sign for fermions. The end points 0 and beta are not reduced.
+  * @tparam T Type of the values, double or dcomplex
+  */
+ template <typename T> class imtime_spline {
+  double beta, delta;
+  bool fermion;
+  long n_intervals, n1, n2, nc;
+  std::vector<T> coefs;
+
+  // Reduce tau to [0,beta] (kept as is if it is already in it) : returns the sign, sets the interval and the position in it
+  double reduce(double tau, long &i, double &s) const {
+   double p = ((tau >= 0) && (tau <= beta)) ? 0 : std::floor(tau / beta);
+   tau -= p * beta;
+   i = std::min(long(tau / delta), n_intervals - 1);
+   s = tau - i * delta;
+   return (fermion && (long(p) % 2 != 0)) ? -1 : 1;
+  }
+
+  public:
+  /// Build the spline from a gf in imaginary time
+  template <typename G> explicit imtime_spline(G const &g) {
+   static_assert(is_gf_or_view<G, imtime>::value, "imtime_spline : the gf must be in imaginary time");
+   static_assert(std14::decay_t<decltype(g.data())>::rank <= 3, "imtime_spline : the target must be a scalar or a matrix");
+   auto const &m = g.mesh();
+   long L = m.size();
+   if (L < 4) TRIQS_RUNTIME_ERROR << "imtime_spline : the mesh has " << L << " points, at least 4 are needed";
+   beta = m.domain().beta;
+   delta = m.delta();
+   fermion = (m.domain().statistic == Fermion);
+   n_intervals = L - 1;
+   auto sh = g.data().shape();
+   n1 = (sh.size() > 1 ? sh[1] : 1);
+   n2 = (sh.size() > 2 ? sh[2] : 1);
+   auto f = details::make_flat_data<const T>(g.data());
+   nc = f.n_components();
+
+   // Second derivatives M of the spline : tridiagonal system with the same matrix for all the components,
+   // 2 1 / 1 4 1 / ... / 1 2, solved by the Thomas algorithm.
+   double h = delta;
+   std::vector<T> M(L * nc);
+   std::vector<double> cp(L);
+   for (long c = 0; c < nc; ++c) {
+    T d0 = (-11.0 * f(0, c) + 18.0 * f(1, c) - 9.0 * f(2, c) + 2.0 * f(3, c)) / (6 * h);
+    T d1 = (11.0 * f(L - 1, c) - 18.0 * f(L - 2, c) + 9.0 * f(L - 3, c) - 2.0 * f(L - 4, c)) / (6 * h);
+    M[c] = 6 / h * ((f(1, c) - f(0, c)) / h - d0);
+    for (long i = 1; i < L - 1; ++i) M[i * nc + c] = 6 * (f(i + 1, c) - 2.0 * f(i, c) + f(i - 1, c)) / (h * h);
+    M[(L - 1) * nc + c] = 6 / h * (d1 - (f(L - 1, c) - f(L - 2, c)) / h);
+   }
+   cp[0] = 0.5;
+   for (long c = 0; c < nc; ++c) M[c] *= 0.5;
+   for (long i = 1; i < L; ++i) {
+    double diag = (i == L - 1 ? 2 : 4) - cp[i - 1];
+    cp[i] = 1 / diag;
+    for (long c = 0; c < nc; ++c) M[i * nc + c] = (M[i * nc + c] - M[(i - 1) * nc + c]) / diag;
+   }
+   for (long i = L - 2; i >= 0; --i)
+    for (long c = 0; c < nc; ++c) M[i * nc + c] -= cp[i] * M[(i + 1) * nc + c];
+
+   coefs.resize(n_intervals * 4 * nc);
+   for (long i = 0; i < n_intervals; ++i) {
+    T *a = coefs.data() + i * 4 * nc;
+    for (long c = 0; c < nc; ++c) {
+     T m0 = M[i * nc + c], m1 = M[(i + 1) * nc + c];
+     a[c] = f(i, c);
+     a[nc + c] = (f(i + 1, c) - f(i, c)) / h - h * (2.0 * m0 + m1) / 6;
+     a[2 * nc + c] = m0 / 2;
+     a[3 * nc + c] = (m1 - m0) / (6 * h);
+    }
+   }
+  }
+
+  /// Value of the component (i,j) at tau
+  T operator()(double tau, long i, long j) const {
+   long k;
+   double s;
+   double sign = reduce(tau, k, s);
+   T const *a = coefs.data() + k * 4 * nc + i * n2 + j;
+   return sign * (a[0] + s * (a[nc] + s * (a[2 * nc] + s * a[3 * nc])));
+  }
+
+  /// Value of a scalar valued gf at tau
+  T operator()(double tau) const { return operator()(tau, 0, 0); }
+
+  /// All the components at tau, in the matrix out
+  template <typename MatrixView> void evaluate(double tau, MatrixView &&out) const {
+   long k;
+   double s;
+   double sign = reduce(tau, k, s);
+   T const *a = coefs.data() + k * 4 * nc;
+   for (long i = 0; i < n1; ++i)
+    for (long j = 0; j < n2; ++j) {
+     long c = i * n2 + j;
+     out(i, j) = sign * (a[c] + s * (a[nc + c] + s * (a[2 * nc + c] + s * a[3 * nc + c])));
+    }
+  }
+
+  /// Inverse temperature
+  double get_beta() const { return beta; }
+
+  /// Shape of the target
+  utility::mini_vector<long, 2> target_shape() const { return {n1, n2}; }
+ };
+
+ /// Make the spline of a gf in imaginary time, real or complex valued
+ template <typename G> imtime_spline<typename std14::decay_t<decltype(std::declval<G>().data())>::value_type> make_imtime_spline(G const &g) {
+  return imtime_spline<typename std14::decay_t<decltype(std::declval<G>().data())>::value_type>{g};
+ }
+}
+}
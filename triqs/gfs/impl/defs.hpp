@@ -55,6 +55,7 @@ namespace gfs {
   struct None{};
   struct Product{};
   struct Linear1d{};
+  struct Cubic1d{};
   struct Linear2d{};
  }
 
@@ -97,6 +98,9 @@ namespace gfs {
            typename Singularity = gf_default_singularity_t<Mesh, Target>, typename Evaluator = void>
  class gf_const_view;
 
+ // Assign the data of an elementwise expression in a single flat loop, if possible (cf gf_expr.hpp)
+ template <typename D, typename RHS> bool gf_assign_data_elementwise(D &data, RHS const &rhs);
+
  /*----------------------------------------------------------
   *   Useful metafunctions, traits
   *--------------------------------------------------------*/   
@@ -208,7 +208,8 @@ namespace gfs {
   template <typename RHS> gf & operator=(RHS &&rhs) {
    this->_mesh = rhs.mesh();
    this->_data.resize(get_gf_data_shape(rhs));
-   for (auto const &w : this->mesh()) (*this)[w] = rhs[w];
+   if (!gf_assign_data_elementwise(this->_data, rhs))
+    for (auto const &w : this->mesh()) (*this)[w] = rhs[w];
    this->_singularity = rhs.singularity();
    // to be implemented : there is none in the gf_expr in particular....
    // this->_symmetry = rhs.symmetry();
@@ -172,6 +172,117 @@ namespace triqs { namespace gfs {
 
 #undef DEFINE_OPERATOR
 
+ // -------------------------------------------------------------------
+ // Fast path for the assignment of elementwise expressions.
+ // When the expression acts elementwise on the data arrays (sums and differences of gfs, products and divisions by scalars),
+ // and all the data have the same (contiguous) layout, it is evaluated in a single flat loop over the whole data,
+ // instead of mesh point by mesh point through the data proxies.
+
+ namespace gfs_expr_tools {
+
+  template <typename T> struct is_scalar_node : std::false_type {};
+  template <typename S> struct is_scalar_node<scalar_wrap<S>> : std::true_type {};
+
+  template <typename T> struct is_scalar_target : std::false_type {};
+  template <> struct is_scalar_target<scalar_valued> : std::true_type {};
+  template <> struct is_scalar_target<scalar_real_valued> : std::true_type {};
+
+  template <typename E> struct _elementwise : std::false_type {};
+  template <typename E> using is_elementwise = _elementwise<std14::decay_t<E>>;
+
+  template <typename M, typename T, typename S, typename E>
+  struct _elementwise<gf<M, T, S, E>> : arrays::is_amv_value_or_view_class<typename gf<M, T, S, E>::data_t> {};
+  template <typename M, typename T, typename S, typename E>
+  struct _elementwise<gf_view<M, T, S, E>> : arrays::is_amv_value_or_view_class<typename gf_view<M, T, S, E>::data_t> {};
+  template <typename M, typename T, typename S, typename E>
+  struct _elementwise<gf_const_view<M, T, S, E>> : arrays::is_amv_value_or_view_class<typename gf_const_view<M, T, S, E>::data_t> {};
+  template <typename S> struct _elementwise<scalar_wrap<S>> : std::true_type {};
+  template <typename L> struct _elementwise<gf_unary_m_expr<L>> : is_elementwise<L> {};
+
+  // For a matrix target, g + 1 adds the identity, g1 * g2 and 1/g are matrix products and inverses : not elementwise.
+  template <typename Tag, bool SL, bool SR, bool ScalarTarget> struct _elementwise_op : std::integral_constant<bool, ScalarTarget> {};
+  template <bool ST> struct _elementwise_op<utility::tags::plus, false, false, ST> : std::true_type {};
+  template <bool ST> struct _elementwise_op<utility::tags::minus, false, false, ST> : std::true_type {};
+  template <bool SR, bool ST> struct _elementwise_op<utility::tags::multiplies, true, SR, ST> : std::true_type {};
+  template <bool ST> struct _elementwise_op<utility::tags::multiplies, false, true, ST> : std::true_type {};
+  template <bool ST> struct _elementwise_op<utility::tags::divides, false, true, ST> : std::true_type {};
+
+  template <typename Tag, typename L, typename R>
+  struct _elementwise<gf_expr<Tag, L, R>>
+     : std::integral_constant<bool, is_elementwise<L>::value && is_elementwise<R>::value &&
+                                        _elementwise_op<Tag, is_scalar_node<std14::decay_t<L>>::value,
+                                                        is_scalar_node<std14::decay_t<R>>::value,
+                                                        is_scalar_target<typename gf_expr<Tag, L, R>::target_t>::value>::value> {};
+
+  // The flat version of the nodes : x[k] is the value at the k-th element of the data
+  template <typename T> struct flat_data {
+   T const *p;
+   T operator[](long k) const { return p[k]; }
+  };
+  template <typename S> struct flat_scalar {
+   S s;
+   S operator[](long) const { return s; }
+  };
+  template <typename Tag, typename L, typename R> struct flat_binary {
+   L l;
+   R r;
+   auto operator[](long k) const DECL_AND_RETURN(utility::operation<Tag>()(l[k], r[k]));
+  };
+  template <typename L> struct flat_neg {
+   L l;
+   auto operator[](long k) const DECL_AND_RETURN(-l[k]);
+  };
+
+  // Makes the flat version of an elementwise expression. ok is set to false if one of the data has not the layout im.
+  template <typename IM> struct flattener {
+   IM const &im;
+   bool ok;
+
+   template <typename D> flat_data<typename D::value_type> leaf(D const &d) {
+    ok = ok && (d.indexmap().lengths() == im.lengths()) && (d.indexmap().strides() == im.strides());
+    return {d.data_start()};
+   }
+   template <typename M, typename T, typename S, typename E> auto operator()(gf<M, T, S, E> const &g) DECL_AND_RETURN(leaf(g.data()));
+   template <typename M, typename T, typename S, typename E>
+   auto operator()(gf_view<M, T, S, E> const &g) DECL_AND_RETURN(leaf(g.data()));
+   template <typename M, typename T, typename S, typename E>
+   auto operator()(gf_const_view<M, T, S, E> const &g) DECL_AND_RETURN(leaf(g.data()));
+
+   // integers are promoted, since e.g. int * std::complex<double> is not defined
+   template <typename S, typename R = std14::conditional_t<std::is_integral<std14::decay_t<S>>::value, double, std14::decay_t<S>>>
+   flat_scalar<R> operator()(scalar_wrap<S> const &x) {
+    return {static_cast<R>(x.s)};
+   }
+   template <typename L> auto operator()(gf_unary_m_expr<L> const &x) -> flat_neg<decltype((*this)(x.l))> {
+    return {(*this)(x.l)};
+   }
+   template <typename Tag, typename L, typename R>
+   auto operator()(gf_expr<Tag, L, R> const &x) -> flat_binary<Tag, decltype((*this)(x.l)), decltype((*this)(x.r))> {
+    return {(*this)(x.l), (*this)(x.r)};
+   }
+  };
+
+  template <typename D, typename RHS> bool assign_data_elementwise(D &, RHS const &, std::false_type) { return false; }
+
+  template <typename D, typename RHS> bool assign_data_elementwise(D &data, RHS const &rhs, std::true_type) {
+   auto const &im = data.indexmap();
+   if (!im.is_contiguous()) return false;
+   flattener<std14::decay_t<decltype(im)>> F{im, true};
+   auto f = F(rhs);
+   if (!F.ok) return false;
+   auto *out = data.data_start(); // NB : may alias the data of rhs, which is fine since the expression is elementwise
+   long N = im.domain().number_of_elements();
+#pragma omp parallel for schedule(static) if (N > 100000)
+   for (long k = 0; k < N; ++k) out[k] = f[k];
+   return true;
+  }
+ }
+
+ template <typename D, typename RHS> bool gf_assign_data_elementwise(D &data, RHS const &rhs) {
+  using ok_t = std::integral_constant<bool, arrays::is_amv_value_or_view_class<D>::value && gfs_expr_tools::is_elementwise<RHS>::value>;
+  return gfs_expr_tools::assign_data_elementwise(data, rhs, ok_t{});
+ }
+
 }}//namespace triqs::gf
 #endif
 
@@ -33,27 +33,42 @@ namespace gfs {
  //  * otherwise        : then map returns a std::vector<>
  namespace impl {
 
-#ifndef TRIQS_CPP11
-  template <typename F, typename T> auto _map(F &&f, std::vector<T> const &V) {
-   std::vector<std14::result_of_t<F(T)>> res;
+  // In parallel, the results are first default constructed, then assigned by the threads.
+  // Otherwise (or for bool, which vector packs), they are built in order.
+  template <typename R, typename F, typename T>
+  std::vector<R> _map_impl(F &&f, std::vector<T> const &V, block_execution, std::false_type) {
+   std::vector<R> res;
    res.reserve(V.size());
    for (auto &x : V) res.emplace_back(f(x));
    return res;
   }
 
-  template <typename F, typename T>
-  auto _map(F &&f, std::vector<std::vector<T>> const &V) {
-   std::vector<std::vector<std14::result_of_t<F(T)>>> res;
-   res.reserve(V.size());
-   for (auto &x : V) res.push_back(_map(f,x));
+  template <typename R, typename F, typename T>
+  std::vector<R> _map_impl(F &&f, std::vector<T> const &V, block_execution policy, std::true_type) {
+   if (policy == block_execution::serial) return _map_impl<R>(f, V, policy, std::false_type{});
+   std::vector<R> res(V.size());
+   for_each_block(V.size(), [&](long i) { res[i] = f(V[i]); });
    return res;
   }
+
+  template <typename F, typename T>
+#ifndef TRIQS_CPP11
+  auto _map(F &&f, std::vector<T> const &V, block_execution policy = block_execution::serial) {
 #else
-  // C++11 can not use auto, and vec vec is not useful (block2 is C++14 only).
-  template <typename F, typename T> std::vector<std14::result_of_t<F(T)>> _map(F &&f, std::vector<T> const &V) {
-   std::vector<std14::result_of_t<F(T)>> res;
+  std::vector<std14::result_of_t<F(T)>> _map(F &&f, std::vector<T> const &V, block_execution policy = block_execution::serial) {
+#endif
+   using R = std14::result_of_t<F(T)>;
+   using can_assign_t = std::integral_constant<bool, std::is_default_constructible<R>::value && !std::is_same<R, bool>::value>;
+   return _map_impl<R>(f, V, policy, can_assign_t{});
+  }
+
+  // C++11 : vec vec is not useful (block2 is C++14 only).
+#ifndef TRIQS_CPP11
+  template <typename F, typename T>
+  auto _map(F &&f, std::vector<std::vector<T>> const &V, block_execution policy = block_execution::serial) {
+   std::vector<std::vector<std14::result_of_t<F(T)>>> res;
    res.reserve(V.size());
-   for (auto &x : V) res.emplace_back(f(x));
+   for (auto &x : V) res.push_back(_map(f, x, policy));
    return res;
   }
 #endif
@@ -64,34 +79,37 @@ namespace gfs {
 
   // general case
   template <typename F, typename G, typename R> struct map {
-   static auto invoke(F &&f, G &&g) RETURN(_map(std::forward<F>(f), std::forward<G>(g).data()));
+   static auto invoke(F &&f, G &&g, block_execution p = block_execution::serial)
+       RETURN(_map(std::forward<F>(f), std::forward<G>(g).data(), p));
   };
 
   // now , when R is a gf, gf_view, a gf_const_view
   template <typename F, typename G, typename... T> struct map<F, G, gf<T...>> {
-   static auto invoke(F &&f, G &&g)
-       RETURN(make_block_gf(g.mesh(), _map(std::forward<F>(f), std::forward<G>(g).data())));
+   static auto invoke(F &&f, G &&g, block_execution p = block_execution::serial)
+       RETURN(make_block_gf(g.mesh(), _map(std::forward<F>(f), std::forward<G>(g).data(), p)));
   };
 
   template <typename F, typename G, typename... T> struct map<F, G, gf_view<T...>> {
-   static auto invoke(F &&f, G &&g)
-       RETURN(make_block_gf_view(g.mesh(), _map(std::forward<F>(f), std::forward<G>(g).data())));
+   static auto invoke(F &&f, G &&g, block_execution p = block_execution::serial)
+       RETURN(make_block_gf_view(g.mesh(), _map(std::forward<F>(f), std::forward<G>(g).data(), p)));
   };
 
   template <typename F, typename G, typename... T> struct map<F, G, gf_const_view<T...>> {
-   static auto invoke(F &&f, G &&g)
-       RETURN(make_block_gf_const_view(g.mesh(), _map(std::forward<F>(f), std::forward<G>(g).data())));
+   static auto invoke(F &&f, G &&g, block_execution p = block_execution::serial)
+       RETURN(make_block_gf_const_view(g.mesh(), _map(std::forward<F>(f), std::forward<G>(g).data(), p)));
   };
  }
 
+ // The blocks are computed in parallel with block_execution::parallel : f must then be thread safe.
 #ifndef TRIQS_CPP11
- template <typename F, typename G> auto map_block_gf(F &&f, G &&g) {
+ template <typename F, typename G> auto map_block_gf(F &&f, G &&g, block_execution p = block_execution::serial) {
   static_assert(is_block_gf_or_view<G>::value, "map_block_gf requires a block gf");
-  return impl::map<F, G>::invoke(std::forward<F>(f), std::forward<G>(g));
+  return impl::map<F, G>::invoke(std::forward<F>(f), std::forward<G>(g), p);
  }
 #else
  template <typename F, typename G>
- auto map_block_gf(F &&f, G &&g) RETURN((impl::map<F, G>::invoke(std::forward<F>(f), std::forward<G>(g))));
+ auto map_block_gf(F &&f, G &&g, block_execution p = block_execution::serial)
+     RETURN((impl::map<F, G>::invoke(std::forward<F>(f), std::forward<G>(g), p)));
 #endif
 
  // the map function itself...
@@ -116,6 +134,18 @@ namespace gfs {
  template <typename G> auto f(gf<block_index, G> const &g) RETURN(map_block_gf(impl::_mapped_##f{}, g));                         \
  template <typename G> auto f(gf_const_view<block_index, G> g) RETURN(map_block_gf(impl::_mapped_##f{}, g));
 
+// Same as TRIQS_PROMOTE_AS_BLOCK_GF_FUNCTION, with the blocks computed in parallel : f must be thread safe
+#define TRIQS_PROMOTE_AS_PARALLEL_BLOCK_GF_FUNCTION(f)                                                                           \
+ namespace impl {                                                                                                                \
+  struct _mapped_##f {                                                                                                           \
+   template <typename T> auto operator()(T &&x)RETURN(f(std::forward<T>(x)));                                                    \
+  };                                                                                                                             \
+ }                                                                                                                               \
+ template <typename G> auto f(gf<block_index, G> &g) RETURN(map_block_gf(impl::_mapped_##f{}, g, block_execution::parallel));     \
+ template <typename G> auto f(gf_view<block_index, G> g) RETURN(map_block_gf(impl::_mapped_##f{}, g, block_execution::parallel)); \
+ template <typename G> auto f(gf<block_index, G> const &g) RETURN(map_block_gf(impl::_mapped_##f{}, g, block_execution::parallel));\
+ template <typename G> auto f(gf_const_view<block_index, G> g) RETURN(map_block_gf(impl::_mapped_##f{}, g, block_execution::parallel));
+
 #define TRIQS_PROMOTE_AS_BLOCK2_GF_FUNCTION(f)                                                                                    \
  namespace impl {                                                                                                                \
   struct _mapped_##f {                                                                                                           \
@@ -128,7 +158,13 @@ namespace gfs {
  template <typename G> auto f(gf_const_view<block2_index, G> g) RETURN(map_block_gf(impl::_mapped_##f{}, g));
 
  TRIQS_PROMOTE_AS_BLOCK_GF_FUNCTION(reinterpret_scalar_valued_gf_as_matrix_valued);
- TRIQS_PROMOTE_AS_BLOCK_GF_FUNCTION(inverse);
+ TRIQS_PROMOTE_AS_PARALLEL_BLOCK_GF_FUNCTION(inverse);
+
+ // invert_in_place returns nothing : it is promoted by hand, each block being inverted in place (batched), in parallel
+ template <typename G> void invert_in_place(gf_view<block_index, G> g) {
+  for_each_block(n_blocks(g), [&](long i) { invert_in_place(g.data()[i]()); });
+ }
+ template <typename G> void invert_in_place(gf<block_index, G> &g) { invert_in_place(g()); }
 
 }
 }
@@ -31,7 +31,8 @@ namespace gfs {
  std14::enable_if_t<!arrays::is_scalar<RHS>::value> triqs_gf_view_assign_delegation(gf_view<M, T, S, E> g, RHS const &rhs) {
   if (!(g.mesh() == rhs.mesh()))
    TRIQS_RUNTIME_ERROR << "Gf Assignment in View : incompatible mesh" << g.mesh() << " vs " << rhs.mesh();
-  for (auto const &w : g.mesh()) g[w] = rhs[w];
+  if (!gf_assign_data_elementwise(g.data(), rhs))
+   for (auto const &w : g.mesh()) g[w] = rhs[w];
   g.singularity() = rhs.singularity();
  }
 
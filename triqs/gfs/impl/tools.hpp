@@ -72,6 +72,36 @@ namespace gfs {
  template<int R> struct _real_target_t_impl<tensor_valued<R>> { using type = tensor_real_valued<R>;};
  template<typename T> using real_target_t = typename _real_target_t_impl<T>::type;
  
+ namespace details {
+
+  // The data of an array as a table (point of the mesh, column) : the mesh is the dimension axis of the array,
+  // the columns are all the other dimensions, given by their offsets from the first element, in C order.
+  // Works for any rank and any strides.
+  template <typename T> struct flat_data {
+   T *start;
+   long stride;
+   std::vector<long> offsets;
+   T &operator()(long i, long c) const { return start[i * stride + offsets[c]]; }
+   long n_components() const { return offsets.size(); }
+  };
+
+  template <typename T, typename A> flat_data<T> make_flat_data(A &&a, int axis = 0) {
+   auto sh = a.shape();
+   auto const &st = a.indexmap().strides();
+   std::vector<long> offsets(1, 0);
+   for (int r = 0; r < int(sh.size()); ++r) {
+    if (r == axis) continue;
+    std::vector<long> o;
+    o.reserve(offsets.size() * sh[r]);
+    for (auto x : offsets)
+     for (long k = 0; k < long(sh[r]); ++k) o.push_back(x + k * st[r]);
+    offsets = std::move(o);
+   }
+   T *start = a.data_start();
+   return {start, st[axis], std::move(offsets)};
+  }
+ }
+
  //------------------------------------------------------
 
  using dcomplex = std::complex<double>;
@@ -151,6 +151,57 @@ namespace gfs {
    return id.w0 * f[id.i0] + id.w1 * f[id.i1];
   }
 
+  // -------------- Evaluation of a function on a batch of points --------------------------
+
+  /// Number of mesh points involved in the interpolation at one point
+  static constexpr int interpolation_stencil(interpol_t::Linear1d) { return 2; }
+  static constexpr int interpolation_stencil(interpol_t::Cubic1d) { return 4; }
+
+  /// Interpolation data for a batch of points
+  /**
+   * For each x[k], the indices i and the weights w of the m = interpolation_stencil(policy) mesh points used by the
+   * interpolation : f(x[k]) = sum_{p < m} w[k * m + p] * f[i[k * m + p]].
+   * The loops are plain arithmetic on contiguous arrays, vectorized by the compiler.
+   * Throws if one of the points is out of the mesh.
+   * @param x, n The points and their number
+   * @param i, w The indices and the weights, of size n * m
+   */
+  void get_interpolation_data(interpol_t::Linear1d, double const *x, long n, long *i, double *w) const {
+   long imax = L - 2;
+   bool out = false;
+   for (long k = 0; k < n; ++k) {
+    double a = (x[k] - xmin) / del;
+    long i0 = std::min(std::max(long(std::floor(a)), 0l), imax);
+    double t = a - i0;
+    out |= (t < -1.e-12) | (t > 1 + 1.e-12);
+    t = std::min(std::max(t, 0.0), 1.0);
+    i[2 * k] = i0;
+    i[2 * k + 1] = i0 + 1;
+    w[2 * k] = 1 - t;
+    w[2 * k + 1] = t;
+   }
+   if (out) TRIQS_RUNTIME_ERROR << "out of window";
+  }
+
+  /// Cubic interpolation : Lagrange polynomial on the 4 closest points (one sided at the boundaries of the mesh)
+  void get_interpolation_data(interpol_t::Cubic1d, double const *x, long n, long *i, double *w) const {
+   if (L < 4) TRIQS_RUNTIME_ERROR << "cubic interpolation on a mesh of " << L << " points";
+   bool out = false;
+   for (long k = 0; k < n; ++k) {
+    double a = (x[k] - xmin) / del;
+    out |= (a < -1.e-12) | (a > L - 1 + 1.e-12);
+    a = std::min(std::max(a, 0.0), double(L - 1));
+    long j = std::min(std::max(long(std::floor(a)) - 1, 0l), L - 4);
+    double t = a - j, t1 = t - 1, t2 = t - 2, t3 = t - 3;
+    for (int p = 0; p < 4; ++p) i[4 * k + p] = j + p;
+    w[4 * k] = -t1 * t2 * t3 / 6;
+    w[4 * k + 1] = t * t2 * t3 / 2;
+    w[4 * k + 2] = -t * t1 * t3 / 2;
+    w[4 * k + 3] = t * t1 * t2 / 6;
+   }
+   if (out) TRIQS_RUNTIME_ERROR << "out of window";
+  }
+
   // -------------------- MPI -------------------
 
   /*
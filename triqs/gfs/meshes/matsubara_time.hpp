@@ -87,6 +87,22 @@ namespace gfs {
    auto id = this->get_interpolation_data(default_interpol_policy{}, x);
    return id.w0 * f[id.i0] + id.w1 * f[id.i1];
   }
+
+  /// Interpolation data for a batch of points, with the same reduction to [0,beta] and sign as above
+  template <typename Policy> void get_interpolation_data(Policy policy, double const *x, long n, long *i, double *w) const {
+   double beta = this->domain().beta;
+   bool fermion = (this->domain().statistic == Fermion);
+   std::vector<double> tau(n), sign(n);
+   for (long k = 0; k < n; ++k) {
+    double p = std::floor(x[k] / beta);
+    tau[k] = x[k] - p * beta;
+    sign[k] = (fermion && (long(p) % 2 != 0)) ? -1 : 1;
+   }
+   B::get_interpolation_data(policy, tau.data(), n, i, w);
+   constexpr int m = interpolation_stencil(Policy{});
+   for (long k = 0; k < n; ++k)
+    for (int q = 0; q < m; ++q) w[k * m + q] *= sign[k];
+  }
  };
 
  //-------------------------------------------------------
@@ -0,0 +1,217 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2015 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "./fftw_plan_cache.hpp"
+#include <triqs/utility/exceptions.hpp>
+#include <fftw3.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace triqs {
+namespace gfs {
+ namespace fftw {
+
+  namespace {
+
+   // The kind of transform
+   enum class plan_type { c2c, r2c, redft01, rodft01 };
+
+   // Everything which identifies a plan
+   struct plan_key {
+    plan_type type;
+    std::vector<int> n;
+    int howmany, istride, idist, ostride, odist, sign;
+    bool in_place;
+    unsigned flags;
+    int n_threads;
+
+    bool operator<(plan_key const &k) const {
+     return std::tie(type, n, howmany, istride, idist, ostride, odist, sign, in_place, flags, n_threads) <
+            std::tie(k.type, k.n, k.howmany, k.istride, k.idist, k.ostride, k.odist, k.sign, k.in_place, k.flags, k.n_threads);
+    }
+   };
+
+   // A plan is shared by the cache and by the transforms executing it : it is destroyed by the last owner,
+   // so that clearing the cache while other threads execute its plans is safe.
+   using plan_ptr = std::shared_ptr<std::remove_pointer<fftw_plan>::type>;
+
+   struct plan_cache {
+    std::mutex mutex;
+    std::map<plan_key, plan_ptr> plans;
+    unsigned rigor = FFTW_ESTIMATE;
+    int n_threads = 1;
+    bool threads_initialized = false;
+
+    // The threads of FFTW are initialized once, before any plan is made
+    plan_cache() {
+#ifdef HAVE_FFTW_THREADS
+     threads_initialized = fftw_init_threads();
+#endif
+    }
+
+    // Must be called without the lock : the plans no longer in use are destroyed here, which takes the lock
+    void clear() {
+     std::map<plan_key, plan_ptr> old;
+     {
+      std::lock_guard<std::mutex> lock(mutex);
+      old.swap(plans);
+     }
+    }
+    ~plan_cache() { clear(); }
+   };
+
+   plan_cache &cache() {
+    static plan_cache c;
+    return c;
+   }
+
+   // fftw_destroy_plan is not thread safe : it is serialized with the planning
+   void destroy_plan(fftw_plan p) {
+    std::lock_guard<std::mutex> lock(cache().mutex);
+    fftw_destroy_plan(p);
+   }
+
+   // Number of elements spanned by howmany arrays of N elements with the strides stride and dist
+   long extent(long N, int howmany, int stride, int dist) { return (howmany - 1) * long(dist) + (N - 1) * long(stride) + 1; }
+
+   bool is_aligned(void *p) { return fftw_alignment_of(reinterpret_cast<double *>(p)) == 0; }
+
+   // Find the plan in the cache, or make it with make_plan(scratch_in, scratch_out, flags).
+   // in_size and out_size are the sizes of the in and out arrays, in bytes.
+   template <typename MakePlan> plan_ptr get_plan(plan_key key, void *in, void *out, long in_size, long out_size, MakePlan make_plan) {
+    auto &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    // The plans are made on aligned scratch arrays : the data must be aligned in the same way, or the plan unaligned.
+    key.flags = c.rigor | ((is_aligned(in) && is_aligned(out)) ? 0 : FFTW_UNALIGNED);
+    key.in_place = (in == out);
+    key.n_threads = c.n_threads;
+    auto it = c.plans.find(key);
+    if (it != c.plans.end()) return it->second;
+    // The planner may overwrite its arrays (except with estimate) : never plan on the data
+    auto scratch_in = fftw_malloc(key.in_place ? std::max(in_size, out_size) : in_size);
+    auto scratch_out = (key.in_place ? scratch_in : fftw_malloc(out_size));
+#ifdef HAVE_FFTW_THREADS
+    if (c.threads_initialized) fftw_plan_with_nthreads(c.n_threads);
+#endif
+    fftw_plan p = make_plan(scratch_in, scratch_out, key.flags);
+    if (!key.in_place) fftw_free(scratch_out);
+    fftw_free(scratch_in);
+    if (p == NULL) TRIQS_RUNTIME_ERROR << "FFTW : plan creation failed";
+    auto res = plan_ptr{p, destroy_plan};
+    c.plans.emplace(std::move(key), res);
+    return res;
+   }
+
+   long product(int rank, int const *n) {
+    long N = 1;
+    for (int r = 0; r < rank; ++r) N *= n[r];
+    return N;
+   }
+  }
+
+  //--------------------------------------------------------------------------------------
+
+  void set_planner_rigor(planner_rigor r) {
+   auto &c = cache();
+   std::lock_guard<std::mutex> lock(c.mutex);
+   switch (r) {
+    case planner_rigor::estimate: c.rigor = FFTW_ESTIMATE; break;
+    case planner_rigor::measure: c.rigor = FFTW_MEASURE; break;
+    case planner_rigor::patient: c.rigor = FFTW_PATIENT; break;
+   }
+  }
+
+  void set_n_threads(int n) {
+   auto &c = cache();
+   std::lock_guard<std::mutex> lock(c.mutex);
+   if (c.threads_initialized) c.n_threads = std::max(n, 1);
+  }
+
+  bool import_wisdom(std::string const &filename) {
+   auto &c = cache();
+   std::lock_guard<std::mutex> lock(c.mutex);
+   return fftw_import_wisdom_from_filename(filename.c_str());
+  }
+
+  bool export_wisdom(std::string const &filename) {
+   auto &c = cache();
+   std::lock_guard<std::mutex> lock(c.mutex);
+   return fftw_export_wisdom_to_filename(filename.c_str());
+  }
+
+  void clear_plan_cache() { cache().clear(); }
+
+  long plan_cache_size() {
+   auto &c = cache();
+   std::lock_guard<std::mutex> lock(c.mutex);
+   return c.plans.size();
+  }
+
+  //--------------------------------------------------------------------------------------
+
+  void execute_many_dft(int rank, int const *n, int howmany, std::complex<double> *in, int istride, int idist,
+                        std::complex<double> *out, int ostride, int odist, int sign) {
+   long N = product(rank, n);
+   plan_key key{plan_type::c2c, {n, n + rank}, howmany, istride, idist, ostride, odist, sign};
+   auto p = get_plan(key, in, out, sizeof(fftw_complex) * extent(N, howmany, istride, idist),
+                     sizeof(fftw_complex) * extent(N, howmany, ostride, odist), [&](void *i, void *o, unsigned flags) {
+                      return fftw_plan_many_dft(rank, n, howmany, (fftw_complex *)i, NULL, istride, idist, (fftw_complex *)o, NULL,
+                                                ostride, odist, (sign < 0 ? FFTW_FORWARD : FFTW_BACKWARD), flags);
+                     });
+   fftw_execute_dft(p.get(), reinterpret_cast<fftw_complex *>(in), reinterpret_cast<fftw_complex *>(out));
+  }
+
+  //--------------------------------------------------------------------------------------
+
+  void execute_many_dft_r2c(int rank, int const *n, int howmany, double *in, int istride, int idist, std::complex<double> *out,
+                            int ostride, int odist) {
+   long N = product(rank, n), N_out = (N / n[rank - 1]) * (n[rank - 1] / 2 + 1);
+   plan_key key{plan_type::r2c, {n, n + rank}, howmany, istride, idist, ostride, odist, -1};
+   auto p = get_plan(key, in, out, sizeof(double) * extent(N, howmany, istride, idist),
+                     sizeof(fftw_complex) * extent(N_out, howmany, ostride, odist), [&](void *i, void *o, unsigned flags) {
+                      return fftw_plan_many_dft_r2c(rank, n, howmany, (double *)i, NULL, istride, idist, (fftw_complex *)o, NULL,
+                                                    ostride, odist, flags);
+                     });
+   fftw_execute_dft_r2c(p.get(), in, reinterpret_cast<fftw_complex *>(out));
+  }
+
+  //--------------------------------------------------------------------------------------
+
+  void execute_many_r2r(int rank, int const *n, int howmany, double *in, int istride, int idist, double *out, int ostride, int odist,
+                        r2r_kind kind) {
+   long N = product(rank, n);
+   auto type = (kind == r2r_kind::redft01 ? plan_type::redft01 : plan_type::rodft01);
+   plan_key key{type, {n, n + rank}, howmany, istride, idist, ostride, odist, 0};
+   std::vector<fftw_r2r_kind> kinds(rank, (kind == r2r_kind::redft01 ? FFTW_REDFT01 : FFTW_RODFT01));
+   auto p = get_plan(key, in, out, sizeof(double) * extent(N, howmany, istride, idist), sizeof(double) * extent(N, howmany, ostride, odist),
+                     [&](void *i, void *o, unsigned flags) {
+                      return fftw_plan_many_r2r(rank, n, howmany, (double *)i, NULL, istride, idist, (double *)o, NULL, ostride, odist,
+                                                kinds.data(), flags);
+                     });
+   fftw_execute_r2r(p.get(), in, out);
+  }
+ }
+}
+}
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2015 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <complex>
+#include <string>
+
+namespace triqs {
+namespace gfs {
+ namespace fftw {
+
+  /**
+   * Process-wide cache of the FFTW plans used by the Fourier transforms.
+   *
+   * A plan is created the first time a transform of a given geometry (sizes, number of transforms, strides, direction,
+   * alignment) is requested, on scratch arrays, then executed on the actual data with the new-array execute functions.
+   * Repeated transforms (e.g. in a DMFT loop) hence pay no planning cost.
+   * The cache is thread safe : the planning is serialized, the execution is not.
+   * The plans are reference counted : a transform keeps its plan alive while executing it, so the cache can be cleared
+   * at any time, and a plan is destroyed when its last transform is done.
+   */
+
+  /// Rigor of the FFTW planner
+  enum class planner_rigor { estimate, measure, patient };
+
+  /// Set the rigor of the plans created from now on (estimate by default)
+  /**
+   * With measure or patient, the planning is expensive, but done only once per geometry, and can be saved
+   * across runs with export_wisdom/import_wisdom.
+   */
+  void set_planner_rigor(planner_rigor r);
+
+  /// Set the number of threads used by the plans created from now on (1 by default)
+  /**
+   * Requires FFTW to be compiled with threads support (fftw3_threads), otherwise the call has no effect.
+   */
+  void set_n_threads(int n);
+
+  /// Import the FFTW wisdom from a file. Returns false if the file could not be read.
+  bool import_wisdom(std::string const &filename);
+
+  /// Export the FFTW wisdom to a file. Returns false if the file could not be written.
+  bool export_wisdom(std::string const &filename);
+
+  /// Remove all the plans from the cache
+  /**
+   * Safe while other threads execute transforms : the plans are destroyed once these transforms are done.
+   */
+  void clear_plan_cache();
+
+  /// Number of plans in the cache
+  long plan_cache_size();
+
+  /// Batched complex DFT of rank rank, with a cached plan
+  /**
+   * Arguments as fftw_plan_many_dft (without the embed arrays, and flags), except for sign : -1 (forward) or +1 (backward).
+   * in and out may be the same array (in place transform).
+   */
+  void execute_many_dft(int rank, int const *n, int howmany, std::complex<double> *in, int istride, int idist,
+                        std::complex<double> *out, int ostride, int odist, int sign);
+
+  /// Batched real to complex DFT (sign -1) of rank rank, with a cached plan
+  /**
+   * Arguments as fftw_plan_many_dft_r2c (without the embed arrays, and flags).
+   * Each output has n[rank-1]/2+1 elements in its last dimension, the others follow by hermitian symmetry.
+   */
+  void execute_many_dft_r2c(int rank, int const *n, int howmany, double *in, int istride, int idist, std::complex<double> *out,
+                            int ostride, int odist);
+
+  /// Real to real transforms : the FFTW_REDFT01 (DCT-III) and FFTW_RODFT01 (DST-III) kinds
+  enum class r2r_kind { redft01, rodft01 };
+
+  /// Batched real to real transform, of the same kind in every dimension, with a cached plan
+  /**
+   * Arguments as fftw_plan_many_r2r (without the embed arrays, and flags). in and out may be the same array.
+   */
+  void execute_many_r2r(int rank, int const *n, int howmany, double *in, int istride, int idist, double *out, int ostride, int odist,
+                        r2r_kind kind);
+
+  /// Complex 1d DFT of size n, with a cached plan
+  inline void execute_dft_1d(int n, std::complex<double> *in, std::complex<double> *out, int sign) {
+   execute_many_dft(1, &n, 1, in, 1, 0, out, 1, 0, sign);
+  }
+ }
+}
+}
@@ -19,8 +19,10 @@
  *
  ******************************************************************************/
 #include "fourier_base.hpp"
+#include "./fftw_plan_cache.hpp"
 #include <fftw3.h>
 #include <algorithm>
+#include <vector>
 
 namespace triqs { namespace gfs { namespace details { 
  
@@ -30,23 +32,16 @@ namespace triqs { namespace gfs { namespace details {
   //const size_t L( (direct ? in.size() : out.size()) );
   //const int L(max(in.size(),out.size()));  <-- bug
   
-  fftw_complex *inFFT, *outFFT;
-  fftw_plan p;
-  inFFT = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * L);
-  outFFT = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * L);
-  
+  std::vector<dcomplex> inFFT(L), outFFT(L);
+
   const dcomplex * restrict in_ptr = in.data_start();
   dcomplex * restrict out_ptr = out.data_start();
   const size_t imax = std::min(L,in.size());
-  for (size_t i =0; i<imax; ++i) { inFFT[i][0] = real(in_ptr[i]); inFFT[i][1] = imag(in_ptr[i]);}
-  for (size_t i =imax; i<L; ++i) { inFFT[i][0] = 0; inFFT[i][1] = 0;}
-//   for (size_t i =0; i<L; ++i) { inFFT[i][0] = real(in_ptr[i]); inFFT[i][1] = imag(in_ptr[i]);}
-  p = fftw_plan_dft_1d(L, inFFT, outFFT, (direct ? FFTW_BACKWARD : FFTW_FORWARD), FFTW_ESTIMATE);
-  fftw_execute(p); 
+  for (size_t i =0; i<imax; ++i) inFFT[i] = in_ptr[i];
+  for (size_t i =imax; i<L; ++i) inFFT[i] = 0;
+  fftw::execute_dft_1d(L, inFFT.data(), outFFT.data(), (direct ? FFTW_BACKWARD : FFTW_FORWARD));
   const size_t jmax = std::min(L,out.size());
-  for (size_t j =0; j<jmax; ++j) out_ptr[j] = dcomplex(outFFT[j][0] ,outFFT[j][1]);
-  fftw_destroy_plan(p); 
-  fftw_free(inFFT); fftw_free(outFFT);
+  for (size_t j =0; j<jmax; ++j) out_ptr[j] = outFFT[j];
  }
  
 }}}
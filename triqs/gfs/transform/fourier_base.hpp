@@ -37,9 +37,9 @@ namespace triqs { namespace gfs {
 
  // -------------------------------------------------------------------
 
- // TO BE REPLACED BY A DIRECT CALL to many_fft in fftw, like for lattice case.
  // The implementation of the Fourier transformation
  // Reduce Matrix case to the scalar case.
+ // Used for the real time/frequency : the Matsubara and lattice cases do all the matrix elements in one batched FFT.
  template <typename X, typename Y, typename S>
  void _fourier_impl(gf_view<X, matrix_valued, S> gw, gf_const_view<Y, matrix_valued, S> gt) {
   if (gt.data().shape().front_pop() != gw.data().shape().front_pop())
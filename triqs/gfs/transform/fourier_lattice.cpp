@@ -19,6 +19,7 @@
  *
  ******************************************************************************/
 #include "./fourier_lattice.hpp"
+#include "./fftw_plan_cache.hpp"
 #include <fftw3.h>
 
 #define ASSERT_EQUAL(X,Y,MESS) if (X!=Y) TRIQS_RUNTIME_ERROR << MESS;
@@ -51,27 +52,20 @@ namespace gfs {
 
   auto L = g_in.mesh().get_dimensions();
   auto rank = g_in.mesh().rank();
-  auto in_FFT = reinterpret_cast<fftw_complex*>(g_in.data().data_start());
-  auto outFFT = reinterpret_cast<fftw_complex*>(g_out.data().data_start());
-  // auto p = fftw_plan_dft(rank, L.ptr(), in_FFT, outFFT, FFTW_BACKWARD, FFTW_ESTIMATE);
+  auto in_FFT = const_cast<dcomplex*>(g_in.data().data_start()); // not modified by an out of place transform
+  auto outFFT = g_out.data().data_start();
 
-  // use the general routine that can do all the matrices at once.
-  auto p = fftw_plan_many_dft(rank,                                            // rank
-                              L.ptr(),                                         // the dimension
-                              g_in.data().shape()[1] * g_in.data().shape()[2], // how many FFT : here 1
-                              in_FFT,                                          // in data
-                              NULL,                                            // embed : unused. Doc unclear ?
-                              g_in.data().indexmap().strides()[0],             // stride of the in data
-                              1,                                               // in : shift for multi fft.
-                              outFFT,                                          // out data
-                              NULL,                                            // embed : unused. Doc unclear ?
-                              g_out.data().indexmap().strides()[0],            // stride of the out data
-                              1,                                               // out : shift for multi fft.
-                              sign, FFTW_ESTIMATE);
-
-
-  fftw_execute(p);
-  fftw_destroy_plan(p);
+  // use the general routine that can do all the matrices at once, with a cached plan.
+  fftw::execute_many_dft(rank,                                            // rank
+                         L.ptr(),                                         // the dimension
+                         g_in.data().shape()[1] * g_in.data().shape()[2], // how many FFT : one per matrix element
+                         in_FFT,                                          // in data
+                         g_in.data().indexmap().strides()[0],             // stride of the in data
+                         1,                                               // in : shift for multi fft.
+                         outFFT,                                          // out data
+                         g_out.data().indexmap().strides()[0],            // stride of the out data
+                         1,                                               // out : shift for multi fft.
+                         sign);
  }
 
  //--------------------------------------------------------------------------------------
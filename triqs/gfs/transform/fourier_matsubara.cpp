@@ -19,191 +19,324 @@
  *
  ******************************************************************************/
 #include "fourier_matsubara.hpp"
+#include "./fftw_plan_cache.hpp"
 #include <fftw3.h>
 
 namespace triqs {
 namespace gfs {
 
- //--------------------------------------------------------------------------------------
+ namespace {
 
- struct impl_worker {
+  // Below this number of elements, the loops are not parallelized (OpenMP)
+  const long parallel_threshold = 100000;
 
-  arrays::vector<dcomplex> g_in, g_out;
+  using details::flat_data;
+  using details::make_flat_data;
+  using details::tail_coefs;
 
-  dcomplex oneFermion(dcomplex a, double b, double tau, double beta) {
-   return -a * (b >= 0 ? exp(-b * tau) / (1 + exp(-beta * b)) : exp(b * (beta - tau)) / (1 + exp(beta * b)));
+  // The coefficients of the tail of a matrix valued gf
+  tail_coefs make_tail_coefs(tail_const_view ta) {
+   tail_coefs tc(0);
+   auto d = ta(1), A = ta.get_or_zero(2), B = ta.get_or_zero(3);
+   for (long i = 0; i < long(first_dim(d)); ++i)
+    for (long j = 0; j < long(second_dim(d)); ++j) {
+     tc.d.push_back(d(i, j));
+     tc.A.push_back(A(i, j));
+     tc.B.push_back(B(i, j));
+    }
+   return tc;
   }
 
-  dcomplex oneBoson(dcomplex a, double b, double tau, double beta) {
-   return a * (b >= 0 ? exp(-b * tau) / (exp(-beta * b) - 1) : exp(b * (beta - tau)) / (1 - exp(b * beta)));
+  // The part of the tail subtracted before the FFT : sum_k a_k / (i omega_n - b_k),
+  // i.e. sum_k a_k basis(b_k, tau) in time.
+  struct tail_fit {
+   bool is_fermion;
+   double b[3];
+   std::vector<dcomplex> a[3];
+
+   tail_fit(bool is_fermion, tail_coefs const &tc) : is_fermion(is_fermion) {
+    long n = tc.d.size();
+    for (auto &x : a) x.resize(n);
+    if (is_fermion) {
+     b[0] = 0;
+     b[1] = 1;
+     b[2] = -1;
+     for (long c = 0; c < n; ++c) {
+      a[0][c] = tc.d[c] - tc.B[c];
+      a[1][c] = (tc.A[c] + tc.B[c]) / 2;
+      a[2][c] = (tc.B[c] - tc.A[c]) / 2;
+     }
+    } else {
+     b[0] = -0.5;
+     b[1] = -1;
+     b[2] = 1;
+     for (long c = 0; c < n; ++c) {
+      a[0][c] = 4 * (tc.d[c] - tc.B[c]) / 3;
+      a[1][c] = tc.B[c] - (tc.d[c] + tc.A[c]) / 2;
+      a[2][c] = tc.d[c] / 6 + tc.A[c] / 2 + tc.B[c] / 3;
+     }
+    }
+   }
+
+   // Time dependence of the term 1/(i omega_n - b)
+   double basis(double b, double tau, double beta) const {
+    if (is_fermion) return -(b >= 0 ? exp(-b * tau) / (1 + exp(-beta * b)) : exp(b * (beta - tau)) / (1 + exp(beta * b)));
+    return (b >= 0 ? exp(-b * tau) / (exp(-beta * b) - 1) : exp(b * (beta - tau)) / (1 - exp(b * beta)));
+   }
+  };
+
+  void check_sizes(gf_mesh<imtime> const &mt, gf_mesh<imfreq> const &mw, long n_gt, long n_gw) {
+   if (n_gt != n_gw) TRIQS_RUNTIME_ERROR << "Fourier : size of target mismatch";
+   if (mt.size() - 1 < 2 * (mw.last_index() + 1))
+    TRIQS_RUNTIME_ERROR << "Fourier: The time mesh mush be at least twice as long as the number of positive frequencies :\n gt.mesh().size() =  "
+                        << mt.size() << " gw.mesh().last_index()" << mw.last_index();
   }
 
   //-------------------------------------
 
-  void direct(gf_view<imfreq, scalar_valued> gw, gf_const_view<imtime, scalar_valued> gt) {
-   auto ta = gt.singularity();
-   direct_impl(make_gf_view_without_tail(gw), make_gf_view_without_tail(gt), ta);
-   gw.singularity() = gt.singularity(); // set tail
+  // Is g(tau) - tail real ? Then g(-i omega_n) = g(i omega_n)^*
+  bool is_real_in_tau(flat_data<const dcomplex> const &gt, long L, tail_fit const &fit, double tolerance = 1.e-13) {
+   long n = gt.n_components();
+   for (auto const &a : fit.a)
+    for (auto const &x : a)
+     if (std::abs(x.imag()) > tolerance) return false;
+   for (long k = 0; k <= L; ++k)
+    for (long c = 0; c < n; ++c)
+     if (std::abs(gt(k, c).imag()) > tolerance) return false;
+   return true;
   }
 
-  void direct(gf_view<imfreq, scalar_valued, no_tail> gw, gf_const_view<imtime, scalar_valued, no_tail> gt) {
-   auto ta = tail{1,1};
-   direct_impl(gw, gt, ta);
+  // The FFT of fact * (g(tau) - tail) for all the components at once : a single batched FFT, with the components as the
+  // innermost dimension of the buffers, and the tail subtracted with the time dependence computed once per tau.
+  // The row m of the result is the frequency of index m (mod L).
+  std::vector<dcomplex> direct_fft_complex(flat_data<const dcomplex> const &gt, gf_mesh<imtime> const &mt, tail_fit const &fit,
+                                           double fact) {
+   long n = gt.n_components();
+   int L = mt.size() - 1;
+   double beta = mt.domain().beta;
+   dcomplex iomega = M_PI * 1_j / beta;
+   auto const &a0 = fit.a[0], &a1 = fit.a[1], &a2 = fit.a[2];
+
+   std::vector<dcomplex> g_in(L * n), g_out(L * n);
+#pragma omp parallel for if (L * n > parallel_threshold)
+   for (long k = 0; k < L; ++k) {
+    double tau = mt.index_to_point(k);
+    dcomplex e = (fit.is_fermion ? fact * exp(iomega * tau) : fact);
+    double f0 = fit.basis(fit.b[0], tau, beta), f1 = fit.basis(fit.b[1], tau, beta), f2 = fit.basis(fit.b[2], tau, beta);
+    dcomplex *p = g_in.data() + k * n;
+    for (long c = 0; c < n; ++c) p[c] = e * (gt(k, c) - (a0[c] * f0 + a1[c] * f1 + a2[c] * f2));
+   }
+
+   // in our convention backward is direct
+   fftw::execute_many_dft(1, &L, n, g_in.data(), n, 1, g_out.data(), n, 1, FFTW_BACKWARD);
+   return g_out;
   }
-  
-  //-------------------------------------
 
-  private:
-  void direct_impl(gf_view<imfreq, scalar_valued, no_tail> gw, gf_const_view<imtime, scalar_valued, no_tail> gt,
-                   tail const& ta) {
-   // TO BE MODIFIED AFTER SCALAR IMPLEMENTATION TODO
-   dcomplex d = ta(1)(0, 0), A = ta.get_or_zero(2)(0, 0), B = ta.get_or_zero(3)(0, 0);
-   double b1 = 0, b2 = 0, b3 = 0;
-   dcomplex a1, a2, a3;
-   double beta = gt.mesh().domain().beta;
-   auto L = gt.mesh().size() - 1;
-   if (L < 2*(gw.mesh().last_index()+1))
-    TRIQS_RUNTIME_ERROR << "Fourier: The time mesh mush be at least twice as long as the number of positive frequencies :\n gt.mesh().size() =  " << gt.mesh().size()
-                        << " gw.mesh().last_index()" << gw.mesh().last_index();
-   double fact = beta / L;
-   dcomplex iomega = M_PI * 1_j / beta;
-   bool is_fermion = (gw.domain().statistic == Fermion);
-
-   if (is_fermion) {
-    b1 = 0;
-    b2 = 1;
-    b3 = -1;
-    a1 = d - B;
-    a2 = (A + B) / 2;
-    a3 = (B - A) / 2;
-   } else {
-    b1 = -0.5;
-    b2 = -1;
-    b3 = 1;
-    a1 = 4 * (d - B) / 3;
-    a2 = B - (d + A) / 2;
-    a3 = d / 6 + A / 2 + B / 3;
+  // Same for a real g(tau) - tail : only the frequencies of index m >= 0 are computed, with real transforms.
+  // The row m of the result is the frequency of index m. For a Fermion, L must be even.
+  std::vector<dcomplex> direct_fft_real(flat_data<const dcomplex> const &gt, gf_mesh<imtime> const &mt, tail_fit const &fit,
+                                        double fact) {
+   long n = gt.n_components();
+   int L = mt.size() - 1;
+   double beta = mt.domain().beta;
+   std::vector<double> a0(n), a1(n), a2(n);
+   for (long c = 0; c < n; ++c) {
+    a0[c] = fit.a[0][c].real();
+    a1[c] = fit.a[1][c].real();
+    a2[c] = fit.a[2][c].real();
    }
 
-   //debug: check it is useless ...
-   //a1=0; a2=0;a3=0;
-
-   g_in.resize(L + 1);
-   g_out.resize(L);
-   g_in() = 0;
- 
-   if (is_fermion) {
-    for (auto const & t : gt.mesh())
-       g_in[t.index()] = fact * exp(iomega * t) *
-                         (gt[t] - (oneFermion(a1, b1, t, beta) + oneFermion(a2, b2, t, beta) + oneFermion(a3, b3, t, beta)));
-   } else {
-    for (auto const & t : gt.mesh())
-       g_in[t.index()] = fact * (gt[t] - (oneBoson(a1, b1, t, beta) + oneBoson(a2, b2, t, beta) + oneBoson(a3, b3, t, beta)));
+   std::vector<double> h(L * n);
+#pragma omp parallel for if (L * n > parallel_threshold)
+   for (long k = 0; k < L; ++k) {
+    double tau = mt.index_to_point(k);
+    double f0 = fit.basis(fit.b[0], tau, beta), f1 = fit.basis(fit.b[1], tau, beta), f2 = fit.basis(fit.b[2], tau, beta);
+    double *p = h.data() + k * n;
+    for (long c = 0; c < n; ++c) p[c] = fact * (gt(k, c).real() - (a0[c] * f0 + a1[c] * f1 + a2[c] * f2));
    }
-   g_in[L] = 0;
 
-   auto g_in_fft = reinterpret_cast<fftw_complex*>(g_in.data_start());
-   auto g_out_fft = reinterpret_cast<fftw_complex*>(g_out.data_start());
- 
-   auto p = fftw_plan_dft_1d(L, g_in_fft, g_out_fft, FFTW_BACKWARD, FFTW_ESTIMATE); // in our convention backward is direct
-   fftw_execute(p); 
-   fftw_destroy_plan(p); 
+   if (!fit.is_fermion) {
+    // sum_k h_k exp(2 i pi m k / L) is the conjugate of the r2c transform
+    std::vector<dcomplex> g_out((L / 2 + 1) * n);
+    fftw::execute_many_dft_r2c(1, &L, n, h.data(), n, 1, g_out.data(), n, 1);
+    for (auto &x : g_out) x = std::conj(x);
+    return g_out;
+   }
 
-   //details::fourier_base(g_in, g_out, L, true);
+   // Fermion, L = 2M : for 0 <= m < M, sum_k h_k exp(i pi (2m+1) k / L) is
+   //  - for the real part, a DCT-III of size M of (h_k - h_{L-k})/2 (h_0 for k=0)
+   //  - for the imaginary part, a DST-III of size M of (h_k + h_{L-k})/2 (h_M for k=M)
+   int M = L / 2;
+   std::vector<double> x_re(M * n), x_im(M * n);
+   for (long c = 0; c < n; ++c) {
+    x_re[c] = h[c];
+    x_im[(M - 1) * n + c] = h[M * n + c];
+   }
+   for (long k = 1; k < M; ++k) {
+    double const *p = h.data() + k * n, *q = h.data() + (L - k) * n;
+    for (long c = 0; c < n; ++c) {
+     x_re[k * n + c] = (p[c] - q[c]) / 2;
+     x_im[(k - 1) * n + c] = (p[c] + q[c]) / 2;
+    }
+   }
+   fftw::execute_many_r2r(1, &M, n, x_re.data(), n, 1, x_re.data(), n, 1, fftw::r2r_kind::redft01);
+   fftw::execute_many_r2r(1, &M, n, x_im.data(), n, 1, x_im.data(), n, 1, fftw::r2r_kind::rodft01);
+   std::vector<dcomplex> g_out(M * n);
+   for (long i = 0; i < M * n; ++i) g_out[i] = dcomplex(x_re[i], x_im[i]);
+   return g_out;
+  }
+
+  // Direct transformation of all the components at once.
+  // If g(tau) is real, the transform is done with real FFTs of half the cost, and the negative frequencies
+  // (if any in the mesh) are deduced from g(-i omega_n) = g(i omega_n)^*.
+  void direct_impl(flat_data<dcomplex> const &gw, gf_mesh<imfreq> const &mw, flat_data<const dcomplex> const &gt,
+                   gf_mesh<imtime> const &mt, tail_coefs const &tc) {
+   long n = gt.n_components();
+   check_sizes(mt, mw, n, gw.n_components());
+   if (n == 0) return;
+   int L = mt.size() - 1;
+   double beta = mt.domain().beta;
+   double fact = beta / L;
+   bool is_fermion = (mw.domain().statistic == Fermion);
+   tail_fit fit(is_fermion, tc);
+   auto const &a0 = fit.a[0], &a1 = fit.a[1], &a2 = fit.a[2];
+
+   bool real = (!is_fermion || (L % 2 == 0)) && is_real_in_tau(gt, L, fit);
+   auto g_out = (real ? direct_fft_real(gt, mt, fit, fact) : direct_fft_complex(gt, mt, fit, fact));
 
-   // I do not see the use of this term
-   // If the discontinuity is perfectly correct, this term is 0.
    // We manually remove half of the first time point contribution and add half
    // of the last time point contribution. This is necessary to make sure that no symmetry is lost
-   dcomplex corr = -0.5 * fact * (gt[0] + d + (is_fermion ? 1 : -1) * gt[L]);
-   for (auto const& w : gw.mesh()) gw[w] = g_out((w.index() + L) % L) + corr + a1 / (w - b1) + a2 / (w - b2) + a3 / (w - b3);
-   
-   //for (auto const& w : gw.mesh()) gw[w] = g_out((w.index() + L) % L) + a1 / (w - b1) + a2 / (w - b2) + a3 / (w - b3);
+   std::vector<dcomplex> corr(n);
+   for (long c = 0; c < n; ++c) corr[c] = -0.5 * fact * (gt(0, c) + tc.d[c] + (is_fermion ? 1 : -1) * gt(L, c));
+
+#pragma omp parallel for if (mw.size() * n > parallel_threshold)
+   for (long i = 0; i < long(mw.size()); ++i) {
+    long m = mw.linear_to_index(i);
+    dcomplex iw = mw.index_to_point(m);
+    dcomplex h0 = 1 / (iw - fit.b[0]), h1 = 1 / (iw - fit.b[1]), h2 = 1 / (iw - fit.b[2]);
+    bool conj = real && (m < 0);
+    if (conj)
+     m = (is_fermion ? -m - 1 : -m);
+    else if (!real)
+     m = (m + L) % L;
+    dcomplex const *p = g_out.data() + m * n;
+    if (conj)
+     for (long c = 0; c < n; ++c) gw(i, c) = std::conj(p[c]) + corr[c] + a0[c] * h0 + a1[c] * h1 + a2[c] * h2;
+    else
+     for (long c = 0; c < n; ++c) gw(i, c) = p[c] + corr[c] + a0[c] * h0 + a1[c] * h1 + a2[c] * h2;
+   }
   }
 
-  public:
   //-------------------------------------
 
-  void inverse(gf_view<imtime, scalar_valued> gt, gf_const_view<imfreq, scalar_valued> gw) {
-   if (gw.mesh().positive_only()) TRIQS_RUNTIME_ERROR << "Fourier is only implemented for g(i omega_n) with full mesh (positive and negative frequencies)";
-   auto ta = gw.singularity();
-   // TO BE MODIFIED AFTER SCALAR IMPLEMENTATION TODO
-   dcomplex d = ta(1)(0, 0), A = ta.get_or_zero(2)(0, 0), B = ta.get_or_zero(3)(0, 0);
-   double b1, b2, b3;
-   dcomplex a1, a2, a3;
-   double beta = gw.domain().beta;
-   long L = gt.mesh().size() - 1;
-   if (L < 2*(gw.mesh().last_index()+1))
-    TRIQS_RUNTIME_ERROR << "Inverse Fourier: The time mesh mush be at least twice as long as the freq mesh :\n gt.mesh().size() =  " << gt.mesh().size()
-                        << " gw.mesh().last_index()" << gw.mesh().last_index();
-   dcomplex iomega = M_PI* 1_j / beta;
+  void inverse_impl(flat_data<dcomplex> const &gt, gf_mesh<imtime> const &mt, flat_data<const dcomplex> const &gw,
+                    gf_mesh<imfreq> const &mw, tail_coefs const &tc) {
+   if (mw.positive_only())
+    TRIQS_RUNTIME_ERROR << "Fourier is only implemented for g(i omega_n) with full mesh (positive and negative frequencies)";
+   long n = gw.n_components();
+   check_sizes(mt, mw, gt.n_components(), n);
+   if (n == 0) return;
+   int L = mt.size() - 1;
+   double beta = mw.domain().beta;
    double fact = 1.0 / beta;
-   bool is_fermion = (gw.domain().statistic == Fermion);
- 
-   if (is_fermion) {
-    b1 = 0;
-    b2 = 1;
-    b3 = -1;
-    a1 = d - B;
-    a2 = (A + B) / 2;
-    a3 = (B - A) / 2;
-   } else {
-    b1 = -0.5;
-    b2 = -1;
-    b3 = 1;
-    a1 = 4 * (d - B) / 3;
-    a2 = B - (d + A) / 2;
-    a3 = d / 6 + A / 2 + B / 3;
-   }
-
-   g_in.resize(L); // L>=2*(gw.mesh().last_index()+1) , we will fill the middle array with 0
-   g_out.resize(L + 1);
+   dcomplex iomega = M_PI * 1_j / beta;
+   bool is_fermion = (mw.domain().statistic == Fermion);
+   tail_fit fit(is_fermion, tc);
+   auto const &a0 = fit.a[0], &a1 = fit.a[1], &a2 = fit.a[2];
 
-   g_in() = 0;
-   for (auto const& w : gw.mesh()) g_in[(w.index() + L) % L] = fact * (gw[w] - (a1 / (w - b1) + a2 / (w - b2) + a3 / (w - b3)));
+   // L>=2*(gw.mesh().last_index()+1) , the middle of the array is 0
+   std::vector<dcomplex> g_in(L * n, 0), g_out(L * n);
+#pragma omp parallel for if (mw.size() * n > parallel_threshold)
+   for (long i = 0; i < long(mw.size()); ++i) {
+    long m = mw.linear_to_index(i);
+    dcomplex iw = mw.index_to_point(m);
+    dcomplex h0 = 1 / (iw - fit.b[0]), h1 = 1 / (iw - fit.b[1]), h2 = 1 / (iw - fit.b[2]);
+    dcomplex *p = g_in.data() + ((m + L) % L) * n;
+    for (long c = 0; c < n; ++c) p[c] = fact * (gw(i, c) - (a0[c] * h0 + a1[c] * h1 + a2[c] * h2));
+   }
 
-   auto g_in_fft = reinterpret_cast<fftw_complex*>(g_in.data_start());
-   auto g_out_fft = reinterpret_cast<fftw_complex*>(g_out.data_start());
- 
-   auto p = fftw_plan_dft_1d(L, g_in_fft, g_out_fft, FFTW_FORWARD, FFTW_ESTIMATE); // in our convention backward is inverse FFT
-   fftw_execute(p); 
-   fftw_destroy_plan(p); 
+   // in our convention forward is inverse FFT
+   fftw::execute_many_dft(1, &L, n, g_in.data(), n, 1, g_out.data(), n, 1, FFTW_FORWARD);
 
-   if (is_fermion) {
-    for (auto const & t : gt.mesh()) {
-      gt[t] = g_out(t.index()) * exp(-iomega * t) + oneFermion(a1, b1, t, beta) + oneFermion(a2, b2, t, beta) +
-              oneFermion(a3, b3, t, beta);
-    }
-   } else {
-    for (auto const & t : gt.mesh())
-      gt[t] = g_out(t.index()) + oneBoson(a1, b1, t, beta) + oneBoson(a2, b2, t, beta) + oneBoson(a3, b3, t, beta);
+#pragma omp parallel for if (L * n > parallel_threshold)
+   for (long k = 0; k < L; ++k) {
+    double tau = mt.index_to_point(k);
+    dcomplex e = (is_fermion ? exp(-iomega * tau) : 1);
+    double f0 = fit.basis(fit.b[0], tau, beta), f1 = fit.basis(fit.b[1], tau, beta), f2 = fit.basis(fit.b[2], tau, beta);
+    dcomplex const *p = g_out.data() + k * n;
+    for (long c = 0; c < n; ++c) gt(k, c) = p[c] * e + a0[c] * f0 + a1[c] * f1 + a2[c] * f2;
    }
    double pm = (is_fermion ? -1 : 1);
-   gt.on_mesh(L) = pm * (gt.on_mesh(0) + ta(1)(0, 0));
-   // set tail
-   gt.singularity() = gw.singularity();
+   for (long c = 0; c < n; ++c) gt(L, c) = pm * (gt(0, c) + tc.d[c]);
   }
 
- }; // class worker
+  // The tails of the components of a tensor valued gf
+  tail_coefs make_tail_coefs(arrays::array_const_view<tail, 3> ta) {
+   tail_coefs tc(0);
+   for (auto const &t : ta) {
+    tc.d.push_back(t(1)(0, 0));
+    tc.A.push_back(t.get_or_zero(2)(0, 0));
+    tc.B.push_back(t.get_or_zero(3)(0, 0));
+   }
+   return tc;
+  }
+ }
+
+ //--------------------------------------------
+
+ void details::fourier_matsubara_direct(flat_data<dcomplex> const &gw, gf_mesh<imfreq> const &mw, flat_data<const dcomplex> const &gt,
+                                        gf_mesh<imtime> const &mt, tail_coefs const &tc) {
+  direct_impl(gw, mw, gt, mt, tc);
+ }
+
+ void details::fourier_matsubara_inverse(flat_data<dcomplex> const &gt, gf_mesh<imtime> const &mt, flat_data<const dcomplex> const &gw,
+                                         gf_mesh<imfreq> const &mw, tail_coefs const &tc) {
+  inverse_impl(gt, mt, gw, mw, tc);
+ }
 
  //--------------------------------------------
 
  // Direct transformation imtime -> imfreq, with a tail
+ void _fourier_impl(gf_view<imfreq, matrix_valued, tail> gw, gf_const_view<imtime, matrix_valued, tail> gt) {
+  direct_impl(make_flat_data<dcomplex>(gw.data()), gw.mesh(), make_flat_data<const dcomplex>(gt.data()), gt.mesh(), make_tail_coefs(gt.singularity()));
+  gw.singularity() = gt.singularity(); // set tail
+ }
+
+ void _fourier_impl(gf_view<imfreq, matrix_valued, no_tail> gw, gf_const_view<imtime, matrix_valued, no_tail> gt) {
+  auto fgt = make_flat_data<const dcomplex>(gt.data());
+  direct_impl(make_flat_data<dcomplex>(gw.data()), gw.mesh(), fgt, gt.mesh(), tail_coefs(fgt.n_components()));
+ }
+
+ // Inverse transformation imfreq -> imtime: tail is mandatory
+ void _fourier_impl(gf_view<imtime, matrix_valued, tail> gt, gf_const_view<imfreq, matrix_valued, tail> gw) {
+  inverse_impl(make_flat_data<dcomplex>(gt.data()), gt.mesh(), make_flat_data<const dcomplex>(gw.data()), gw.mesh(), make_tail_coefs(gw.singularity()));
+  gt.singularity() = gw.singularity(); // set tail
+ }
+
+ // The scalar case is the 1x1 matrix case
  void _fourier_impl(gf_view<imfreq, scalar_valued, tail> gw, gf_const_view<imtime, scalar_valued, tail> gt) {
-  impl_worker w;
-  w.direct(gw, gt);
+  _fourier_impl(reinterpret_scalar_valued_gf_as_matrix_valued(gw), reinterpret_scalar_valued_gf_as_matrix_valued(gt));
  }
 
  void _fourier_impl(gf_view<imfreq, scalar_valued, no_tail> gw, gf_const_view<imtime, scalar_valued, no_tail> gt) {
-  impl_worker w;
-  w.direct(gw, gt);
+  _fourier_impl(reinterpret_scalar_valued_gf_as_matrix_valued(gw), reinterpret_scalar_valued_gf_as_matrix_valued(gt));
  }
 
- // Inverse transformation imfreq -> imtime: tail is mandatory
  void _fourier_impl(gf_view<imtime, scalar_valued, tail> gt, gf_const_view<imfreq, scalar_valued, tail> gw) {
-  impl_worker w;
-  w.inverse(gt, gw);
+  _fourier_impl(reinterpret_scalar_valued_gf_as_matrix_valued(gt), reinterpret_scalar_valued_gf_as_matrix_valued(gw));
+ }
+
+ // Tensor valued : the tails are given component by component
+ void _fourier_impl(gf_view<imfreq, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gw,
+                    gf_const_view<imtime, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gt, arrays::array_const_view<tail, 3> ta) {
+  if (ta.shape() != get_target_shape(gt)) TRIQS_RUNTIME_ERROR << "Fourier : the shape of the tails does not match the target";
+  direct_impl(make_flat_data<dcomplex>(gw.data()), gw.mesh(), make_flat_data<const dcomplex>(gt.data()), gt.mesh(), make_tail_coefs(ta));
+ }
+
+ void _fourier_impl(gf_view<imtime, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gt,
+                    gf_const_view<imfreq, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gw, arrays::array_const_view<tail, 3> ta) {
+  if (ta.shape() != get_target_shape(gw)) TRIQS_RUNTIME_ERROR << "Inverse Fourier : the shape of the tails does not match the target";
+  inverse_impl(make_flat_data<dcomplex>(gt.data()), gt.mesh(), make_flat_data<const dcomplex>(gw.data()), gw.mesh(), make_tail_coefs(ta));
  }
 }
 }
-
@@ -40,10 +40,36 @@ namespace gfs {
   return {g};
  }
 
+ namespace details {
+
+  // The coefficients of order 1, 2, 3 of the tails of the columns
+  struct tail_coefs {
+   std::vector<dcomplex> d, A, B;
+   tail_coefs(long n) : d(n, 0), A(n, 0), B(n, 0) {}
+  };
+
+  // The Matsubara transforms of all the columns at once, by a single batched FFT
+  void fourier_matsubara_direct(flat_data<dcomplex> const &gw, gf_mesh<imfreq> const &mw, flat_data<const dcomplex> const &gt,
+                                gf_mesh<imtime> const &mt, tail_coefs const &tc);
+  void fourier_matsubara_inverse(flat_data<dcomplex> const &gt, gf_mesh<imtime> const &mt, flat_data<const dcomplex> const &gw,
+                                 gf_mesh<imfreq> const &mw, tail_coefs const &tc);
+ }
+
  void _fourier_impl(gf_view<imfreq, scalar_valued, tail> gw, gf_const_view<imtime, scalar_valued, tail> gt);
  void _fourier_impl(gf_view<imfreq, scalar_valued, no_tail> gw, gf_const_view<imtime, scalar_valued, no_tail> gt);
  void _fourier_impl(gf_view<imtime, scalar_valued, tail> gt, gf_const_view<imfreq, scalar_valued, tail> gw);
 
+ // All the components of a matrix (or tensor) valued gf are transformed at once, by a single batched FFT.
+ void _fourier_impl(gf_view<imfreq, matrix_valued, tail> gw, gf_const_view<imtime, matrix_valued, tail> gt);
+ void _fourier_impl(gf_view<imfreq, matrix_valued, no_tail> gw, gf_const_view<imtime, matrix_valued, no_tail> gt);
+ void _fourier_impl(gf_view<imtime, matrix_valued, tail> gt, gf_const_view<imfreq, matrix_valued, tail> gw);
+
+ // Tensor valued gf have no tail : the tails of the components are given separately
+ void _fourier_impl(gf_view<imfreq, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gw,
+                    gf_const_view<imtime, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gt, arrays::array_const_view<tail, 3> ta);
+ void _fourier_impl(gf_view<imtime, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gt,
+                    gf_const_view<imfreq, tensor_valued<3>, tail_zero<array<dcomplex, 3>>> gw, arrays::array_const_view<tail, 3> ta);
+
  /**
   *
   */
@@ -19,6 +19,8 @@
  *
  ******************************************************************************/
 #include "./base.hpp"
+#include <vector>
+#include <algorithm>
 
 namespace triqs {
 namespace h5 {
@@ -52,6 +54,101 @@ namespace h5 {
   return ds;
  }
 
+ /****************** Dataset creation property list *********************************************/
+
+ proplist dataset_creation_proplist(write_policy const &p, int rank, hsize_t const *dims, std::size_t elem_size, bool is_floating) {
+  std::size_t n_bytes = elem_size;
+  for (int u = 0; u < rank; ++u) n_bytes *= dims[u];
+  if (p.is_default() || (rank == 0) || (n_bytes == 0) || (n_bytes < p.min_bytes)) return H5P_DEFAULT;
+
+  // chunk : full last dimensions, and the part of the first ones which fits in chunk_bytes
+  std::vector<hsize_t> chunk(dims, dims + rank);
+  for (int u = 0; u < rank; ++u) {
+   std::size_t rest = elem_size;
+   for (int v = u + 1; v < rank; ++v) rest *= dims[v];
+   chunk[u] = std::min<hsize_t>(dims[u], std::max<std::size_t>(1, p.chunk_bytes / rest));
+   if ((chunk[u] > 1) || (rest <= p.chunk_bytes)) break;
+  }
+
+  return chunked_dataset_creation_proplist(p, rank, chunk.data(), is_floating);
+ }
+
+ proplist chunked_dataset_creation_proplist(write_policy const &p, int rank, hsize_t const *chunk, bool is_floating) {
+  proplist pl = H5Pcreate(H5P_DATASET_CREATE);
+  if (H5Pset_chunk(pl, rank, chunk) < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot set the chunk of a dataset";
+  if ((p.scale_offset_digits >= 0) && is_floating) {
+   if (!H5Zfilter_avail(H5Z_FILTER_SCALEOFFSET)) TRIQS_RUNTIME_ERROR << "HDF5 : the scale-offset filter is not available";
+   H5Pset_scaleoffset(pl, H5Z_SO_FLOAT_DSCALE, p.scale_offset_digits);
+  }
+  if (p.shuffle) H5Pset_shuffle(pl);
+  if (p.deflate_level > 0) {
+   if (!H5Zfilter_avail(H5Z_FILTER_DEFLATE)) TRIQS_RUNTIME_ERROR << "HDF5 : the deflate filter is not available";
+   if (H5Pset_deflate(pl, std::min(p.deflate_level, 9)) < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot set the deflate filter";
+  }
+  return pl;
+ }
+
+ /****************** Compact storage *********************************************/
+
+ proplist compact_dataset_creation_proplist(hid_t ty, hid_t sp, std::size_t max_bytes) {
+  if (H5Tis_variable_str(ty) > 0) return H5P_DEFAULT;
+  int rank = H5Sget_simple_extent_ndims(sp);
+  if (rank < 0) return H5P_DEFAULT;
+  std::vector<hsize_t> dims(rank), maxdims(rank);
+  H5Sget_simple_extent_dims(sp, dims.data(), maxdims.data());
+  if (dims != maxdims) return H5P_DEFAULT; // an extendable dataset must be chunked
+  hssize_t n = H5Sget_simple_extent_npoints(sp);
+  std::size_t n_bytes = H5Tget_size(ty) * std::size_t(n);
+  if ((n <= 0) || (n_bytes > std::min<std::size_t>(max_bytes, 60000))) return H5P_DEFAULT; // object header messages < 64 kB
+  proplist pl = H5Pcreate(H5P_DATASET_CREATE);
+  if (H5Pset_layout(pl, H5D_COMPACT) < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot set the compact layout of a dataset";
+  return pl;
+ }
+
+ proplist compact_group_creation_proplist() {
+  proplist pl = H5Pcreate(H5P_GROUP_CREATE);
+  // up to 64 links and 64 attributes in the header of the group, instead of a B-tree/heap above 8
+  if ((H5Pset_link_phase_change(pl, 64, 48) < 0) || (H5Pset_attr_phase_change(pl, 64, 48) < 0))
+   TRIQS_RUNTIME_ERROR << "HDF5 : cannot set the compact storage of a group";
+  return pl;
+ }
+
+ /****************** Thread safety *********************************************/
+
+ bool library_is_threadsafe() {
+#if H5_VERSION_GE(1, 8, 16)
+  hbool_t res = false;
+  return (H5is_library_threadsafe(&res) >= 0) && res;
+#elif defined(H5_HAVE_THREADSAFE)
+  return true;
+#else
+  return false;
+#endif
+ }
+
+ /****************** Parallel (MPI-IO) files *********************************************/
+
+ bool file_is_parallel(hid_t obj) {
+#ifdef H5_HAVE_PARALLEL
+  h5_object f = H5Iget_file_id(obj);
+  proplist fapl = H5Fget_access_plist(f);
+  return H5Pget_driver(fapl) == H5FD_MPIO;
+#else
+  return false;
+#endif
+ }
+
+ proplist dataset_transfer_proplist(hid_t obj) {
+#ifdef H5_HAVE_PARALLEL
+  if (file_is_parallel(obj)) {
+   proplist pl = H5Pcreate(H5P_DATASET_XFER);
+   if (H5Pset_dxpl_mpio(pl, H5FD_MPIO_COLLECTIVE) < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot set the collective transfer mode";
+   return pl;
+  }
+#endif
+  return H5P_DEFAULT;
+ }
+
  /****************** Write string attribute *********************************************/
 
  void h5_write_attribute(hid_t id, std::string const & name, std::string const & value) {
@@ -102,6 +102,29 @@ namespace h5 {
  dataspace dataspace_from_LS(int R, bool is_complex, hsize_t const *Ltot, hsize_t const *L, hsize_t const *S,
                              hsize_t const *offset = NULL);
 
+ // dataset creation property list of a dataset of dimensions dims (complex included) and elements of elem_size bytes,
+ // according to the write policy. H5P_DEFAULT for a contiguous dataset.
+ // implemented in base.cpp
+ proplist dataset_creation_proplist(write_policy const &p, int rank, hsize_t const *dims, std::size_t elem_size, bool is_floating);
+
+ // dataset creation property list with the given chunk (compulsory e.g. for an extendable dataset), and the filters of p
+ proplist chunked_dataset_creation_proplist(write_policy const &p, int rank, hsize_t const *chunk, bool is_floating);
+
+ // creation property list of a dataset of type ty on the space sp : compact if it has at most max_bytes, else H5P_DEFAULT
+ proplist compact_dataset_creation_proplist(hid_t ty, hid_t sp, std::size_t max_bytes);
+
+ // creation property list of a group with its links and attributes in its header
+ proplist compact_group_creation_proplist();
+
+ // true iif the HDF5 library is thread safe, i.e. may be called from several threads at the same time
+ bool library_is_threadsafe();
+
+ // true iif the file of the object obj is opened with the MPI-IO driver
+ bool file_is_parallel(hid_t obj);
+
+ // transfer property list for the raw data of the file of obj : collective for MPI-IO, H5P_DEFAULT otherwise
+ proplist dataset_transfer_proplist(hid_t obj);
+
 }
 }
 
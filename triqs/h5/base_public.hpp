@@ -123,6 +123,33 @@ namespace h5 {
 
  using attribute = h5_object;
 
+ //------------- write policy ------------------
+
+ /// How the datasets of the arrays are created in the file
+ /**
+  * By default, the datasets are contiguous and uncompressed.
+  * With one of the filters (deflate, shuffle, scale-offset), or chunked = true, the dataset is chunked.
+  * The chunk shape is the full shape for the last dimensions, and a part of the first ones,
+  * so that a chunk has about chunk_bytes bytes.
+  * The reading is unchanged : the filters are applied transparently by the HDF5 library.
+  * With compact = true, the tiny datasets (scalars, strings, indices, ...) are stored in their object header,
+  * and the groups keep their links and attributes in their header : this saves many small I/O for the archives of
+  * many small objects (block_gf, mc state, parameters).
+  * The policy is set on a file or a group, and is inherited by the groups created or opened from it.
+  */
+ struct write_policy {
+  bool chunked = false;              // chunk the datasets, even without filter
+  int deflate_level = 0;             // level of the deflate (gzip) compression, from 1 to 9. 0 : no compression
+  bool shuffle = false;              // shuffle the bytes before the compression (usually improves it for floating point data)
+  int scale_offset_digits = -1;      // if >= 0, lossy packing of floating point data, keeping this number of decimal digits
+  std::size_t chunk_bytes = 1 << 20; // target size of a chunk in bytes
+  std::size_t min_bytes = 1 << 14;   // smaller datasets are always contiguous and uncompressed
+  bool compact = false;              // compact storage of the tiny datasets, and of the links and attributes of the groups
+  std::size_t compact_bytes = 1024;  // the datasets up to this size are compact (HDF5 limit : 64 kB)
+
+  bool is_default() const { return !chunked && (deflate_level == 0) && !shuffle && (scale_offset_digits < 0); }
+ };
+
  /****************** Read/Write string attribute *********************************************/
 
  /// Write an attribute named name, of type string, of value value to the object id
@@ -1,5 +1,6 @@
 #include "./file.hpp"
 #include "./base.hpp"
+#include <algorithm>
 
 namespace triqs {
 namespace h5 {
@@ -17,31 +18,33 @@ namespace h5 {
 
  file::file(const char* name, char flags) : file(name, h5_char_to_int(flags)) {}
 
- file::file(const char* name, unsigned flags) {
+ file::file(const char* name, unsigned flags) { _open(name, flags, H5P_DEFAULT); }
+
+ void file::_open(const char* name, unsigned flags, hid_t fapl) {
 
   if (flags == H5F_ACC_RDONLY) {
-   id = H5Fopen(name, flags, H5P_DEFAULT);
+   id = H5Fopen(name, flags, fapl);
    if (id < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot open file " << name;
    return;
   }
 
   if (flags == H5F_ACC_RDWR) {
-   id = H5Fopen(name, flags, H5P_DEFAULT);
+   id = H5Fopen(name, flags, fapl);
    if (id < 0) {
-    id = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+    id = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, fapl);
     if (id < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot open file " << name;
    }
    return;
   }
 
   if (flags == H5F_ACC_TRUNC) {
-   id = H5Fcreate(name, flags, H5P_DEFAULT, H5P_DEFAULT);
+   id = H5Fcreate(name, flags, H5P_DEFAULT, fapl);
    if (id < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot create file " << name;
    return;
   }
 
   if (flags == H5F_ACC_EXCL) {
-   id = H5Fcreate(name, flags, H5P_DEFAULT, H5P_DEFAULT);
+   id = H5Fcreate(name, flags, H5P_DEFAULT, fapl);
    if (id < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot create file " << name << ". Does it exists ?";
    return;
   }
@@ -49,6 +52,46 @@ namespace h5 {
   TRIQS_RUNTIME_ERROR << "HDF5 file opening : flag not recognized";
  }
 
+ // the file access property list for p
+ static proplist file_access_proplist(file_access_policy const& p) {
+  proplist fapl = H5Pcreate(H5P_FILE_ACCESS);
+  herr_t err = 0;
+  if (p.core_increment > 0) err |= H5Pset_fapl_core(fapl, p.core_increment, 1);
+  if (p.latest_format) err |= H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+  if (p.alignment > 0) err |= H5Pset_alignment(fapl, p.alignment_threshold, p.alignment);
+  if (p.metadata_block_bytes > 0) err |= H5Pset_meta_block_size(fapl, p.metadata_block_bytes);
+  if (p.small_data_block_bytes > 0) err |= H5Pset_small_data_block_size(fapl, p.small_data_block_bytes);
+  if (p.metadata_cache_bytes > 0) {
+   H5AC_cache_config_t config;
+   config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+   err |= H5Pget_mdc_config(fapl, &config);
+   config.set_initial_size = true;
+   config.initial_size = p.metadata_cache_bytes;
+   config.max_size = std::max<size_t>(config.max_size, p.metadata_cache_bytes);
+   config.min_size = std::min<size_t>(config.min_size, p.metadata_cache_bytes);
+   err |= H5Pset_mdc_config(fapl, &config);
+  }
+  if (err < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot set the file access properties";
+  return fapl;
+ }
+
+ file::file(std::string const& name, char flags, file_access_policy const& p) {
+  _open(name.c_str(), h5_char_to_int(flags), file_access_proplist(p));
+ }
+
+ file::file(std::string const& name, char flags, mpi::communicator c, int root, file_access_policy const& p) {
+#ifdef H5_HAVE_PARALLEL
+  if (p.core_increment > 0) TRIQS_RUNTIME_ERROR << "HDF5 : the core driver cannot be used with MPI-IO for the file " << name;
+  proplist fapl = file_access_proplist(p);
+  if (H5Pset_fapl_mpio(fapl, c.get(), MPI_INFO_NULL) < 0) TRIQS_RUNTIME_ERROR << "HDF5 : cannot set the MPI-IO driver for the file " << name;
+  _open(name.c_str(), h5_char_to_int(flags), fapl);
+#else
+  if (c.rank() == root) _open(name.c_str(), h5_char_to_int(flags), file_access_proplist(p));
+#endif
+ }
+
+ bool file::is_parallel() const { return is_valid() && file_is_parallel(id); }
+
  //---------------------------------------------
 
  file::file(hid_t id_) : h5_object(h5_object(id_)) {}
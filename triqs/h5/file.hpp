@@ -20,10 +20,25 @@
  ******************************************************************************/
 #pragma once
 #include "./base_public.hpp"
+#include <triqs/mpi/base.hpp>
 
 namespace triqs {
 namespace h5 {
 
+ /// Tuning of the access to a file, e.g. for the archives of many small objects on a parallel filesystem
+ /**
+  * Each field left to its default value keeps the HDF5 default.
+  */
+ struct file_access_policy {
+  std::size_t metadata_cache_bytes = 0;      // initial size of the metadata cache (HDF5 default : 2 MB)
+  bool latest_format = false;                // latest file format (compact groups, faster lookups). Older HDF5 may not read it
+  std::size_t alignment = 0;                 // objects of at least alignment_threshold bytes start at a multiple of alignment
+  std::size_t alignment_threshold = 1 << 16; // (e.g. the stripe size of the filesystem)
+  std::size_t metadata_block_bytes = 0;      // metadata aggregated in blocks of this size (HDF5 default : 2 kB)
+  std::size_t small_data_block_bytes = 0;    // small raw data aggregated in blocks of this size (HDF5 default : 2 kB)
+  std::size_t core_increment = 0; // if > 0, the file is built in memory (core driver), by increments of this size, and written at close
+ };
+
  /**
   *  \brief A little handler for the file
   */
@@ -56,12 +71,36 @@ namespace h5 {
   ///
   file(std::string const &name, char flags) : file(name.c_str(), flags) {}
 
+  /// Open the file name, with the access tuned by p. Flag char as above.
+  file(std::string const &name, char flags, file_access_policy const &p);
+
+  /**
+   * Open the file name on all the nodes of the communicator c (collective).
+   * With a parallel HDF5 library, the file is opened with the MPI-IO driver on every node.
+   * With a serial HDF5 library, it is opened on the root only : the file is empty on the other nodes.
+   * Flag char as above. The core driver of p is not available with MPI-IO.
+   */
+  file(std::string const &name, char flags, mpi::communicator c, int root = 0, file_access_policy const &p = {});
+
+  /// True iif the file is opened with the MPI-IO driver
+  bool is_parallel() const;
+
   /// Internal : from an hdf5 id.
   file (hid_t id);
   file(h5_object obj);
 
   /// Name of the file
   std::string name() const;
+
+  /// Policy for the datasets written in the file, through the groups opened after this call
+  void set_write_policy(write_policy const &p) { policy = p; }
+
+  ///
+  write_policy const &get_write_policy() const { return policy; }
+
+  private:
+  write_policy policy;
+  void _open(const char *name, unsigned flags, hid_t fapl);
  };
 }
 }
@@ -4,7 +4,8 @@
 namespace triqs {
 namespace h5 {
 
- group::group(h5::file f) : h5_object() {
+ group::group(h5::file f) : h5_object(), policy(f.get_write_policy()) {
+  if (hid_t(f) == 0) return; // file not opened on this node
   id = H5Gopen2(f, "/", H5P_DEFAULT);
   if (id < 0) TRIQS_RUNTIME_ERROR << "Cannot open the root group / in the file " << f.name();
  }
@@ -34,6 +35,8 @@ namespace h5 {
   return res;
  }
 
+ bool group::is_parallel() const { return is_valid() && file_is_parallel(id); }
+
  bool group::has_key(std::string const &key) const { return H5Lexists(id, key.c_str(), H5P_DEFAULT); }
 
  void group::unlink_key_if_exists(std::string const &key) const {
@@ -47,7 +50,9 @@ namespace h5 {
   if (!has_key(key)) TRIQS_RUNTIME_ERROR << "no subgroup " << key << " in the group";
   hid_t sg = H5Gopen2(id, key.c_str(), H5P_DEFAULT);
   if (sg < 0) TRIQS_RUNTIME_ERROR << "Error in opening the subgroup " << key;
-  return group(sg);
+  group res(sg);
+  res.policy = policy;
+  return res;
  }
 
  /// Open an existing DataSet. Throw if it does not exist.
@@ -65,9 +70,12 @@ namespace h5 {
   */
  group group::create_group(std::string const &key, bool delete_if_exists) const {
   unlink_key_if_exists(key);
-  hid_t id_g = H5Gcreate2(id, key.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  proplist gcpl = (policy.compact ? compact_group_creation_proplist() : proplist{H5P_DEFAULT});
+  hid_t id_g = H5Gcreate2(id, key.c_str(), H5P_DEFAULT, gcpl, H5P_DEFAULT);
   if (id_g < 0) TRIQS_RUNTIME_ERROR << "Cannot create the subgroup " << key << " of the group" << name();
-  return group(id_g);
+  group res(id_g);
+  res.policy = policy;
+  return res;
  }
 
  /**
@@ -78,6 +86,11 @@ namespace h5 {
   */
  dataset group::create_dataset(std::string const &key, datatype ty, dataspace sp, hid_t pl) const {
   unlink_key_if_exists(key);
+  proplist compact_pl;
+  if ((pl == H5P_DEFAULT) && policy.compact && !is_parallel()) { // not with MPI-IO : only one node writes a compact dataset
+   compact_pl = compact_dataset_creation_proplist(ty, sp, policy.compact_bytes);
+   pl = compact_pl;
+  }
   dataset ds = H5Dcreate2(id, key.c_str(), ty, sp, H5P_DEFAULT, pl, H5P_DEFAULT);
   if (!ds.is_valid()) TRIQS_RUNTIME_ERROR << "Cannot create the dataset " << key << " in the group" << name();
   return ds;
@@ -30,6 +30,7 @@ namespace h5 {
   */
  class group : public h5_object {
   void _write_triqs_hdf5_data_scheme(const char *a); // impl.
+  write_policy policy;
 
   public:
   group() = default; // for python converter only
@@ -37,7 +38,7 @@ namespace h5 {
   ///
   group(group const &) = default;
 
-  /// Takes the "/" group at the top of the file
+  /// Takes the "/" group at the top of the file. The group is empty if the file is (cf file opened on a communicator)
   group(h5::file f);
 
   /**
@@ -54,6 +55,9 @@ namespace h5 {
   /// Name of the group
   std::string name() const;
 
+  /// True iif the file of the group is opened with the MPI-IO driver
+  bool is_parallel() const;
+
   ///  Write the triqs tag of the group if it is an object.
   template <typename T> void write_triqs_hdf5_data_scheme(T const &obj) {
    _write_triqs_hdf5_data_scheme(get_triqs_hdf5_data_scheme(obj).c_str());
@@ -94,6 +98,12 @@ namespace h5 {
 
   /// Returns all names of dataset of G
   std::vector<std::string> get_all_dataset_names() const;
+
+  /// Policy for the datasets written in this group, and in the subgroups created or opened from it after this call
+  void set_write_policy(write_policy const &p) { policy = p; }
+
+  ///
+  write_policy const &get_write_policy() const { return policy; }
  };
 }
 }
@@ -0,0 +1,375 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2013, P. Seth, I. Krivenko, M. Ferrero and O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <triqs/arrays/blas_lapack/axpy.hpp>
+#include "./state.hpp"
+
+namespace triqs {
+namespace hilbert_space {
+
+/// Many-body state switching from a sparse to a dense storage
+/**
+  The state starts with a sparse storage: two arrays of basis state indices and amplitudes.
+  When the number of stored amplitudes exceeds `fill_threshold * size()`, it switches to a dense
+  `triqs::arrays::vector` (as [[state]] with `BasedOnMap = false`), and the arithmetic uses BLAS.
+  [[adaptive_state_prune]] converts a dense state back to the sparse storage when it is sparse enough.
+
+  This class models [[statevector_concept]] and can be used as the state type of [[imperative_operator]],
+  [[space_partition]] and [[project]]. A new amplitude is appended to the sparse storage, and found again through a hash table
+  until the arrays are sorted, e.g. by [[adaptive_state_prune]] or `axpy`: filling a state of n amplitudes costs O(n log n).
+
+  @tparam HilbertSpace Hilbert space type, one of [[hilbert_space]] and [[sub_hilbert_space]]
+  @tparam ScalarType Amplitude type, normally `double` or `std::complex<double>`
+  @include triqs/hilbert_space/adaptive_state.hpp
+ */
+template <typename HilbertSpace, typename ScalarType>
+class adaptive_state : boost::additive<adaptive_state<HilbertSpace, ScalarType>>,
+                       boost::multiplicative<adaptive_state<HilbertSpace, ScalarType>, ScalarType> {
+
+ const HilbertSpace* hs_p;
+ double fill_threshold;
+ bool dense = false;
+ // sparse storage : indices and the corresponding amplitudes, sorted up to n_sorted,
+ // followed by the new ones, which are found through their position in pending
+ std::vector<uint64_t> sp_index;
+ std::vector<ScalarType> sp_value;
+ size_t n_sorted = 0;
+ std::unordered_map<uint64_t, size_t> pending;
+ // dense storage
+ triqs::arrays::vector<ScalarType> ampli;
+
+ public:
+
+ /// Accessor to `ScalarType` template parameter
+ using value_type = ScalarType;
+ /// Accessor to `HilbertSpace` template parameter
+ using hilbert_space_t = HilbertSpace;
+
+ /// Construct a new state object
+ /**
+   The constructed state is dummy state not belonging to any Hilbert space. **It should not be used in expressions!**
+  */
+ adaptive_state() : hs_p(nullptr), fill_threshold(0.25) {}
+ /// Construct a new state object
+ /**
+   @param hs Hilbert space the new state belongs to
+   @param fill_threshold Fraction of non-vanishing amplitudes above which the dense storage is used
+  */
+ adaptive_state(HilbertSpace const& hs, double fill_threshold = 0.25) : hs_p(&hs), fill_threshold(fill_threshold) {}
+
+ /// Return the dimension of the associated Hilbert space
+ /**
+   @return Dimension of the associated Hilbert space
+  */
+ uint64_t size() const { return hs_p->size(); }
+
+ /// Access to individual amplitudes
+ /**
+   In the sparse storage, a zero amplitude is inserted if `i` is not stored yet.
+
+   @param i index of the requested amplitude
+   @return Reference to the requested amplitude
+  */
+ value_type& operator()(uint64_t i) {
+  if (dense) return ampli(i);
+  auto k = find(i);
+  if (k < sp_index.size()) return sp_value[k];
+  if (sp_index.size() + 1 > fill_threshold * size()) {
+   make_dense();
+   return ampli(i);
+  }
+  pending.emplace(i, sp_index.size());
+  sp_index.push_back(i);
+  sp_value.push_back(value_type(0));
+  return sp_value.back();
+ }
+
+ /// Access to individual amplitudes
+ /**
+   @param i index of the requested amplitude
+   @return Value of the requested amplitude
+  */
+ value_type operator()(uint64_t i) const {
+  if (dense) return ampli(i);
+  auto k = find(i);
+  return (k < sp_index.size()) ? sp_value[k] : value_type(0);
+ }
+
+ /// In-place addition of another state
+ /**
+   @param s2 Another [[adaptive_state]] object to add
+   @return Reference to this state
+  */
+ adaptive_state& operator+=(adaptive_state const& s2) {
+  axpy(value_type(1), s2, *this);
+  return *this;
+ }
+
+ /// In-place subtraction of another state
+ /**
+   @param s2 Another [[adaptive_state]] object to subtract
+   @return Reference to this state
+  */
+ adaptive_state& operator-=(adaptive_state const& s2) {
+  axpy(value_type(-1), s2, *this);
+  return *this;
+ }
+
+ /// In-place multiplication by a scalar
+ /**
+   @param x Multiplier
+   @return Reference to this state
+  */
+ adaptive_state& operator*=(value_type x) {
+  if (dense)
+   ampli *= x;
+  else
+   for (auto& v : sp_value) v *= x;
+  return *this;
+ }
+
+ /// In-place division by a scalar
+ /**
+   @param x Divisor
+   @return Reference to this state
+  */
+ adaptive_state& operator/=(value_type x) { return operator*=(1 / x); }
+
+ /// Add a multiple of a state to another state, `y += alpha * x`, without temporary
+ /**
+   @param alpha Multiplier
+   @param x State to add
+   @param y State to add to
+  */
+ friend void axpy(value_type alpha, adaptive_state const& x, adaptive_state& y) {
+  if (x.dense) {
+   y.make_dense();
+   triqs::arrays::blas::axpy(alpha, x.ampli, y.ampli);
+   return;
+  }
+  if (y.dense) {
+   for (size_t k = 0; k < x.sp_index.size(); ++k) y.ampli(x.sp_index[k]) += alpha * x.sp_value[k];
+   return;
+  }
+  // Merge two sorted sequences
+  y.sort_pending();
+  adaptive_state x_sorted;
+  if (!x.pending.empty()) {
+   x_sorted = x;
+   x_sorted.sort_pending();
+  }
+  auto const& xs = (x.pending.empty() ? x : x_sorted);
+  auto const nx = xs.sp_index.size(), ny = y.sp_index.size();
+  std::vector<uint64_t> index;
+  std::vector<value_type> value;
+  index.reserve(nx + ny);
+  value.reserve(nx + ny);
+  size_t kx = 0, ky = 0;
+  while (kx < nx || ky < ny) {
+   if (ky == ny || (kx < nx && xs.sp_index[kx] < y.sp_index[ky])) {
+    index.push_back(xs.sp_index[kx]);
+    value.push_back(alpha * xs.sp_value[kx++]);
+   } else if (kx == nx || y.sp_index[ky] < xs.sp_index[kx]) {
+    index.push_back(y.sp_index[ky]);
+    value.push_back(y.sp_value[ky++]);
+   } else {
+    index.push_back(y.sp_index[ky]);
+    value.push_back(y.sp_value[ky++] + alpha * xs.sp_value[kx++]);
+   }
+  }
+  std::swap(y.sp_index, index);
+  std::swap(y.sp_value, value);
+  y.n_sorted = y.sp_index.size();
+  if (y.sp_index.size() > y.fill_threshold * y.size()) y.make_dense();
+ }
+
+ /// Calculate scalar product of two states
+ /**
+   @param s1 First state to multiply
+   @param s2 Second state to multiply
+   @return Value of the scalar product
+  */
+ friend value_type dot_product(adaptive_state const& s1, adaptive_state const& s2) {
+  using triqs::utility::conj;
+  if (s1.dense && s2.dense) return triqs::arrays::dotc(s1.ampli, s2.ampli);
+  value_type res = 0;
+  if (!s1.dense) {
+   for (size_t k = 0; k < s1.sp_index.size(); ++k) res += conj(s1.sp_value[k]) * s2(s1.sp_index[k]);
+  } else {
+   for (size_t k = 0; k < s2.sp_index.size(); ++k) res += conj(s1.ampli(s2.sp_index[k])) * s2.sp_value[k];
+  }
+  return res;
+ }
+
+ /// Apply a callable object to **non-vanishing** amplitudes of a state
+ /**
+  The callable must take two arguments, 1) index of the basis Fock state in the associated Hilbert space, and 2) the corresponding amplitude.
+
+  @tparam Lambda Type of the callable object
+  @param st State object
+  @param l Callable object
+  */
+ template <typename Lambda> friend void foreach(adaptive_state const& st, Lambda l) {
+  if (st.dense) {
+   const auto L = st.size();
+   for (uint64_t i = 0; i < L; ++i)
+    if (st.ampli(i) != value_type(0)) l(i, st.ampli(i));
+  } else {
+   st.for_each_sorted([&l](uint64_t i, value_type const& v) {
+    if (v != value_type(0)) l(i, v);
+   });
+  }
+ }
+
+ //
+ // Additions to StateVector concept
+ //
+
+ /// Is the dense storage used?
+ /**
+   @return `true` if the amplitudes are stored in a dense vector
+  */
+ bool is_dense() const { return dense; }
+
+ /// Switch to the dense storage
+ void make_dense() {
+  if (dense) return;
+  ampli.resize(size());
+  ampli() = value_type(0);
+  for (size_t k = 0; k < sp_index.size(); ++k) ampli(sp_index[k]) = sp_value[k];
+  std::vector<uint64_t>{}.swap(sp_index);
+  std::vector<value_type>{}.swap(sp_value);
+  n_sorted = 0;
+  pending.clear();
+  dense = true;
+ }
+
+ /// Remove the vanishing amplitudes
+ /**
+   A dense state switches back to the sparse storage if less than half of the fill threshold is occupied.
+  */
+ void prune() {
+  using triqs::utility::is_zero;
+  if (dense) {
+   uint64_t n = 0;
+   for (uint64_t i = 0; i < size(); ++i)
+    if (!is_zero(ampli(i))) ++n;
+   if (n > 0.5 * fill_threshold * size()) return;
+   for (uint64_t i = 0; i < size(); ++i)
+    if (!is_zero(ampli(i))) {
+     sp_index.push_back(i);
+     sp_value.push_back(ampli(i));
+    }
+   ampli = triqs::arrays::vector<value_type>{};
+   n_sorted = sp_index.size();
+   dense = false;
+  } else {
+   sort_pending();
+   size_t n = 0;
+   for (size_t k = 0; k < sp_index.size(); ++k)
+    if (!is_zero(sp_value[k])) {
+     sp_index[n] = sp_index[k];
+     sp_value[n++] = sp_value[k];
+    }
+   sp_index.resize(n);
+   sp_value.resize(n);
+   n_sorted = n;
+  }
+ }
+
+ /// Return a constant reference to the associated Hilbert space
+ /**
+   @return Constant reference to the Hilbert space
+  */
+ HilbertSpace const& get_hilbert() const { return *hs_p; }
+ /// Reset the associated Hilbert space
+ /**
+   @param new_hs Constant reference to the new Hilbert space
+  */
+ void set_hilbert(HilbertSpace const& new_hs) { hs_p = &new_hs; }
+
+ /// Make a copy of a given state with all amplitudes set to 0
+ /**
+   @param st State object to copy
+   @return A zero state in the same Hilbert space, with the same fill threshold
+  */
+ friend adaptive_state make_zero_state(adaptive_state const& st) { return {st.get_hilbert(), st.fill_threshold}; }
+
+ private:
+ // Position of the index i in the sparse storage, sp_index.size() if it is not stored
+ size_t find(uint64_t i) const {
+  auto it = std::lower_bound(sp_index.begin(), sp_index.begin() + n_sorted, i);
+  if (it != sp_index.begin() + n_sorted && *it == i) return it - sp_index.begin();
+  auto p = pending.find(i);
+  return (p != pending.end()) ? p->second : sp_index.size();
+ }
+
+ // Call f(i, amplitude) on the sparse storage, in the order of increasing i
+ template <typename F> void for_each_sorted(F f) const {
+  std::vector<size_t> pos(sp_index.size() - n_sorted);
+  std::iota(pos.begin(), pos.end(), n_sorted);
+  std::sort(pos.begin(), pos.end(), [this](size_t a, size_t b) { return sp_index[a] < sp_index[b]; });
+  size_t k = 0;
+  auto p = pos.begin();
+  while (k < n_sorted || p != pos.end()) {
+   size_t q = (p == pos.end() || (k < n_sorted && sp_index[k] < sp_index[*p])) ? k++ : *p++;
+   f(sp_index[q], sp_value[q]);
+  }
+ }
+
+ // Merge the pending amplitudes into the sorted ones
+ void sort_pending() {
+  if (pending.empty()) return;
+  std::vector<uint64_t> index;
+  std::vector<value_type> value;
+  index.reserve(sp_index.size());
+  value.reserve(sp_index.size());
+  for_each_sorted([&index, &value](uint64_t i, value_type const& v) {
+   index.push_back(i);
+   value.push_back(v);
+  });
+  std::swap(sp_index, index);
+  std::swap(sp_value, value);
+  n_sorted = sp_index.size();
+  pending.clear();
+ }
+};
+
+// Print state
+template <typename HilbertSpace, typename ScalarType>
+std::ostream& operator<<(std::ostream& os, adaptive_state<HilbertSpace, ScalarType> const& s) {
+ bool something_written = false;
+ auto const& hs = s.get_hilbert();
+ foreach(s, [&os, hs, &something_written](uint64_t i, ScalarType ampl) {
+  using triqs::utility::is_zero;
+  if (!is_zero(ampl)) {
+   os << " +(" << ampl << ")" << "|" << hs.get_fock_state(i) << ">";
+   something_written = true;
+  }
+ });
+ if (!something_written) os << 0;
+ return os;
+}
+}}
@@ -72,6 +72,7 @@ namespace hilbert_space {
   for (int n = 0; n < v.size(); ++n) {
    map_index_n.insert({to_indices(v[n]), n});
   }
+  _rebuild_hash();
  }
 
  // --- h5
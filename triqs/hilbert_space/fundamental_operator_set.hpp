@@ -26,6 +26,10 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
 
 namespace std {
 inline std::ostream & operator<<(std::ostream & os, std::vector<triqs::utility::variant_int_string> const& fs) {
@@ -57,6 +61,34 @@ class fundamental_operator_set {
  using map_t = std::map<indices_t, int>; // the table index <-> n
  map_t map_index_n;
 
+ // O(1) lookup table : points to the keys and values of map_index_n (map nodes are stable)
+ struct _ptr_hash {
+  std::size_t operator()(indices_t const* p) const { return boost::hash<indices_t>{}(*p); }
+ };
+ struct _ptr_equal {
+  bool operator()(indices_t const* p1, indices_t const* p2) const { return *p1 == *p2; }
+ };
+ using hash_t = std::unordered_map<indices_t const*, int const*, _ptr_hash, _ptr_equal>;
+ hash_t hash_index_n;
+
+ void _rebuild_hash() {
+  hash_index_n.clear();
+  hash_index_n.reserve(map_index_n.size());
+  for (auto const& p : map_index_n) hash_index_n.emplace(&p.first, &p.second);
+ }
+
+ // Fill the set from a range of indices with one sort
+ template <typename It> void _bulk_insert(It first, It last) {
+  reduction_t v = reverse_map();
+  v.insert(v.end(), first, last);
+  std::sort(v.begin(), v.end());
+  v.erase(std::unique(v.begin(), v.end()), v.end());
+  map_index_n.clear();
+  int n = 0;
+  for (auto& ind : v) map_index_n.emplace_hint(map_index_n.end(), std::move(ind), n++);
+  _rebuild_hash();
+ }
+
  // internal only
  fundamental_operator_set(std::vector<std::vector<std::string>> const&);
 
@@ -65,13 +97,26 @@ class fundamental_operator_set {
  /// Construct an empty set
  fundamental_operator_set() {}
 
+ fundamental_operator_set(fundamental_operator_set const& x) : map_index_n(x.map_index_n) { _rebuild_hash(); }
+ fundamental_operator_set(fundamental_operator_set&&) = default;
+ fundamental_operator_set& operator=(fundamental_operator_set const& x) {
+  if (this != &x) {
+   map_index_n = x.map_index_n;
+   _rebuild_hash();
+  }
+  return *this;
+ }
+ fundamental_operator_set& operator=(fundamental_operator_set&&) = default;
+
  /// Construct a set with each stored index being a pair of integers `(i,j)`
  /**
    @param v `i` runs from 0 to `v.size()-1`; `j` runs from 0 to `v[i].size()-1` for each `i`
   */
  fundamental_operator_set(std::vector<int> const& v) {
+  reduction_t r;
   for (int i = 0; i < v.size(); ++i)
-   for (int j = 0; j < v[i]; ++j) insert(i, j);
+   for (int j = 0; j < v[i]; ++j) r.push_back(indices_t{i, j});
+  _bulk_insert(r.begin(), r.end());
  }
 
  /// Construct from a set of generic index sequences
@@ -79,33 +124,48 @@ class fundamental_operator_set {
    @param s Set of indices
   */
  template <typename IndexType> fundamental_operator_set(std::set<IndexType> const& s) {
-  for (auto const& i : s) insert(i);
+  reduction_t r;
+  r.reserve(s.size());
+  for (auto const& i : s) r.push_back(indices_t{i});
+  _bulk_insert(r.begin(), r.end());
  }
 
  /// Construct from a vector of index sequences
  /**
+   The indices are sorted once, duplicates are ignored.
+
    @param v Vector of indices
   */
- explicit fundamental_operator_set(reduction_t const& v) {
-  for (auto const& i : v) insert_from_indices_t(i);
- }
+ explicit fundamental_operator_set(reduction_t const& v) { _bulk_insert(v.begin(), v.end()); }
 
  /// Reduce to a `std::vector<indices_t>`
  explicit operator reduction_t() const { return reverse_map(); }
 
  /// Insert a new index sequence given as `indices_t`
  /**
+   The positions of the index sequences following `ind` are shifted by one.
+   Inserting in increasing order costs O(log n) per element.
+
    @param ind `indices_t` object
   */
  void insert_from_indices_t(indices_t const& ind) {
-  map_index_n.insert({ind, size()});
-  // reorder the indices, which are always given in the order of the indices tuple
-  map_t m;
-  int i = 0;
-  for (auto const& p : map_index_n) m.insert({p.first, i++});
-  std::swap(m, map_index_n);
+  auto r = map_index_n.insert({ind, 0});
+  if (!r.second) return;
+  auto it = r.first;
+  it->second = (it == map_index_n.begin() ? 0 : std::prev(it)->second + 1);
+  for (auto it2 = std::next(it); it2 != map_index_n.end(); ++it2) ++it2->second;
+  hash_index_n.emplace(&it->first, &it->second);
  }
 
+ /// Insert a range of index sequences
+ /**
+   The range is sorted once and merged with the set : prefer it to repeated [[fundamental_operator_set_insert]].
+
+   @param first Iterator to the first `indices_t` object
+   @param last Past-the-end iterator
+  */
+ template <typename It> void insert_range(It first, It last) { _bulk_insert(first, last); }
+
  /// Insert a new index sequence given as multiple `int`/`std::string` arguments
  template <typename... IndexType> void insert(IndexType const&... ind) { insert_from_indices_t(indices_t{ind...}); }
 
@@ -120,7 +180,7 @@ class fundamental_operator_set {
    @param t Index sequence to look up
    @return `true` if `t` is in this set
   */
- bool has_indices(indices_t const& t) const { return map_index_n.count(t) == 1; }
+ bool has_indices(indices_t const& t) const { return hash_index_n.count(&t) == 1; }
 
  /// Request position of a given index sequence
  /**
@@ -128,11 +188,10 @@ class fundamental_operator_set {
    @return Position of the requested index sequence
   */
  int operator[](indices_t const& t) const {
-  try {
-   return map_index_n.at(t);
-  } catch(std::out_of_range &) {
+  auto it = hash_index_n.find(&t);
+  if (it == hash_index_n.end())
    TRIQS_RUNTIME_ERROR << "Operator with indices (" << t << ") does not belong to this fundamental set!";
-  }
+  return *it->second;
  }
 
  /// Build and return the reverse map: `int` -> `indices_t`
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2013, P. Seth, I. Krivenko, M. Ferrero and O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "./hilbert_space.hpp"
+#include <algorithm>
+
+namespace triqs {
+namespace hilbert_space {
+
+ namespace { // auxiliary functions
+
+  // The Fock state with the n lowest bits set
+  fock_state_t lowest_bits(int n) { return (n == fock_state_max_n_bits ? ~fock_state_t(0) : (fock_state_t(1) << n) - 1); }
+
+  // Scatter the lowest bits of x onto the bits set in mask (i.e. a software pdep)
+  fock_state_t deposit_bits(fock_state_t x, fock_state_t mask) {
+   fock_state_t r = 0;
+   for (fock_state_t bit = 1; mask; bit <<= 1) {
+    fock_state_t lowest = mask & (~mask + 1);
+    if (x & bit) r |= lowest;
+    mask ^= lowest;
+   }
+   return r;
+  }
+
+  // All the subsets of the bits of mask with exactly n bits set, in increasing order
+  std::vector<fock_state_t> combinations(fock_state_t mask, int n) {
+   std::vector<fock_state_t> res;
+   int n_bits = count_number_of_bits(mask);
+   if (n < 0 || n > n_bits) return res;
+   if (n == 0) return {0};
+   // Gosper's hack : next integer with the same number of bits set
+   fock_state_t c = lowest_bits(n), last = c << (n_bits - n);
+   while (true) {
+    res.push_back(deposit_bits(c, mask));
+    if (c == last) break;
+    fock_state_t u = c & (~c + 1), v = c + u;
+    c = v + (((v ^ c) / u) >> 2);
+   }
+   return res;
+  }
+ }
+
+ sub_hilbert_space make_sector(fundamental_operator_set const& fops, std::vector<occupation_constraint_t> const& constraints,
+                               int index) {
+  if (fops.size() > fock_state_max_n_bits)
+   TRIQS_RUNTIME_ERROR << "Too many fundamental operators (" << fops.size() << "), at most " << fock_state_max_n_bits
+                       << " are supported";
+
+  fock_state_t free_modes = lowest_bits(fops.size());
+
+  // Start from the vacuum and extend by the combinations of each group in turn
+  std::vector<fock_state_t> states = {0};
+  auto extend = [&states](std::vector<fock_state_t> const& comb) {
+   std::vector<fock_state_t> r;
+   r.reserve(states.size() * comb.size());
+   for (auto f : states)
+    for (auto c : comb) r.push_back(f | c);
+   std::swap(r, states);
+  };
+
+  for (auto const& cons : constraints) {
+   fock_state_t mask = 0;
+   for (auto const& ind : cons.first) mask |= fock_state_t(1) << fops[ind];
+   if ((mask & free_modes) != mask) TRIQS_RUNTIME_ERROR << "make_sector : the groups of operators are not disjoint";
+   free_modes &= ~mask;
+   extend(combinations(mask, cons.second));
+  }
+
+  // Operators which are not constrained can have any occupation
+  std::vector<fock_state_t> free_comb;
+  for (int n = 0; n <= count_number_of_bits(free_modes); ++n) {
+   auto c = combinations(free_modes, n);
+   free_comb.insert(free_comb.end(), c.begin(), c.end());
+  }
+  extend(free_comb);
+
+  std::sort(states.begin(), states.end());
+  sub_hilbert_space sp(index);
+  for (auto f : states) sp.add_fock_state(f);
+  return sp;
+ }
+
+ sub_hilbert_space make_particle_number_sector(fundamental_operator_set const& fops, int n_particles, int index) {
+  auto sp = make_sector(fops, {{fundamental_operator_set::reduction_t(fops), n_particles}}, index);
+  // All the states with n_particles among the fops.size() lowest bits, in increasing order : use the ranking
+  if (sp.size() > 0) {
+   sp.lookup = sub_hilbert_space::lookup_t::ranking;
+   sp.ranking_n_particles = n_particles;
+   sp.ranking_modes = lowest_bits(fops.size());
+  }
+  return sp;
+ }
+}
+}
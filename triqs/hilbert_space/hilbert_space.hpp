@@ -21,8 +21,10 @@
 #pragma once
 
 #include <set>
+#include <algorithm>
 #include <boost/container/flat_map.hpp>
 #include <triqs/utility/exceptions.hpp>
+#include <triqs/h5/scalar.hpp>
 #include <triqs/h5/vector.hpp>
 #include "fundamental_operator_set.hpp"
 
@@ -32,12 +34,46 @@ namespace hilbert_space {
 /// The coding of the fermionic Fock state: 64 bits word in binary.
 using fock_state_t = uint64_t;
 
+/// Maximal number of fundamental operators a Fock state can be built from
+constexpr int fock_state_max_n_bits = 8 * sizeof(fock_state_t);
+
+/// Parity of the number of bits set in a Fock state
+/**
+  @param f Fock state
+  @return `true` if an odd number of bits is set in `f`
+*/
+inline bool parity_number_of_bits(fock_state_t f) { return __builtin_parityll(f); }
+
+/// Number of bits set in a Fock state (number of particles)
+/**
+  @param f Fock state
+  @return Number of occupied single-particle states in `f`
+*/
+inline int count_number_of_bits(fock_state_t f) { return __builtin_popcountll(f); }
+
+namespace details {
+ // Table of the binomial coefficients C(n,k) for 0 <= k <= n <= fock_state_max_n_bits
+ struct binomial_table {
+  uint64_t c[fock_state_max_n_bits + 1][fock_state_max_n_bits + 1];
+  binomial_table() {
+   for (int n = 0; n <= fock_state_max_n_bits; ++n) {
+    c[n][0] = 1;
+    for (int k = 1; k <= fock_state_max_n_bits; ++k) c[n][k] = (n == 0 ? 0 : c[n - 1][k - 1] + c[n - 1][k]);
+   }
+  }
+ };
+ inline uint64_t binomial(int n, int k) {
+  static const binomial_table t;
+  return t.c[n][k];
+ }
+}
+
 /// A Hilbert space spanned from *all* fermionic Fock states generated by a given set of fundamental operators.
 /**
   @include triqs/hilbert_space/hilbert_space.hpp
  */
 class hilbert_space {
- int dim; // the dimension
+ uint64_t dim; // the dimension
 
  public:
 
@@ -48,13 +84,19 @@ class hilbert_space {
  /**
    @param fops Generating fundamental operator set
  */
- hilbert_space(fundamental_operator_set const &fops) : dim(1ull << fops.size()) {}
+ hilbert_space(fundamental_operator_set const &fops) {
+  // the full space has 2^n states, and the number of states itself must fit in an uint64_t
+  if (fops.size() >= fock_state_max_n_bits)
+   TRIQS_RUNTIME_ERROR << "The full Hilbert space of " << fops.size() << " fundamental operators is too big, at most "
+                       << fock_state_max_n_bits - 1 << " are supported. Use a sector (sub_hilbert_space) instead.";
+  dim = uint64_t(1) << fops.size();
+ }
 
  /// Return the total number of the fermionic Fock states in this space
  /**
    @return Size of the Hilbert space
  */
- int size() const { return dim; }
+ uint64_t size() const { return dim; }
 
  /// Check two Hilbert spaces for equality
  /**
@@ -85,7 +127,7 @@ class hilbert_space {
    @param f Fock state in question
    @return State index
  */
- int get_state_index(fock_state_t f) const {
+ uint64_t get_state_index(fock_state_t f) const {
   if (f >= dim) TRIQS_RUNTIME_ERROR << "This index is too big, f = " << f;
   return f;
  }
@@ -95,7 +137,7 @@ class hilbert_space {
    @param i Index of the basis state
    @return Fock state
  */
- fock_state_t get_fock_state(int i) const {
+ fock_state_t get_fock_state(uint64_t i) const {
   if (i >= dim) TRIQS_RUNTIME_ERROR << "This Fock state does not exist (index too big), i = " << i;
   return i;
  }
@@ -108,7 +150,7 @@ class hilbert_space {
  */
  fock_state_t get_fock_state(fundamental_operator_set const &fops, std::set<fundamental_operator_set::indices_t> const& indices) const {
   fock_state_t f = 0;
-  for(auto const& index : indices) f += 1 << fops[index];
+  for(auto const& index : indices) f += fock_state_t(1) << fops[index];
   return f;
  }
 
@@ -147,6 +189,15 @@ class hilbert_space {
 /// Hilbert subspace, as an ordered set of basis Fock states.
 /**
   Subspaces carry an integer index, which allows them to be destinguished as parts of a full Hilbert space.
+
+  The reverse lookup (Fock state -> index) is chosen automatically, from the cheapest to the most general:
+
+  - a subspace built by [[make_particle_number_sector]] uses the combinatorial number system, i.e. the index
+    of a state is computed from its bits, without any table;
+  - as long as the Fock states are added in increasing order, the index is found by a binary search
+    in the list of basis states, without any extra table;
+  - otherwise, a sorted (flat) map from Fock states to indices is built.
+
   @include triqs/hilbert_space/hilbert_space.hpp
  */
 class sub_hilbert_space {
@@ -164,16 +215,18 @@ class sub_hilbert_space {
    @param f Fock state to add
  */
  void add_fock_state(fock_state_t f) {
-  int ind = fock_states.size();
+  if (lookup == lookup_t::ranking) lookup = lookup_t::sorted; // the sector is no longer complete
+  if (lookup == lookup_t::sorted && !fock_states.empty() && f <= fock_states.back()) _build_map();
+  uint64_t ind = fock_states.size();
   fock_states.push_back(f);
-  fock_to_index.insert(std::make_pair(f, ind));
+  if (lookup == lookup_t::map) fock_to_index.insert(std::make_pair(f, ind));
  }
 
  /// Return the total number of the fermionic Fock states in this space
  /**
    @return Size of the Hilbert subspace
  */
- int size() const { return fock_states.size(); }
+ uint64_t size() const { return fock_states.size(); }
 
  /// Check two Hilbert subspaces for equality
  /**
@@ -202,21 +255,38 @@ class sub_hilbert_space {
    @param f Fock state in question
    @return State index
  */
- int get_state_index(fock_state_t f) const { return fock_to_index.find(f)->second; }
+ uint64_t get_state_index(fock_state_t f) const {
+  switch (lookup) {
+   case lookup_t::ranking: { // rank of f among the states with the same number of bits: sum_j C(position of the j-th bit, j)
+    uint64_t r = 0;
+    int j = 0;
+    for (; f; f &= f - 1) r += details::binomial(__builtin_ctzll(f), ++j);
+    return r;
+   }
+   case lookup_t::sorted: return std::lower_bound(fock_states.begin(), fock_states.end(), f) - fock_states.begin();
+   default: return fock_to_index.find(f)->second;
+  }
+ }
 
  /// Check if a given Fock state belongs to this subspace
  /**
    @param f Fock state in question
    @return `true` if `f` belongs to the subspace, `false` otherwise
  */
- bool has_state(fock_state_t f) const { return fock_to_index.count(f) == 1; }
+ bool has_state(fock_state_t f) const {
+  switch (lookup) {
+   case lookup_t::ranking: return ((f & ~ranking_modes) == 0) && (count_number_of_bits(f) == ranking_n_particles);
+   case lookup_t::sorted: return std::binary_search(fock_states.begin(), fock_states.end(), f);
+   default: return fock_to_index.count(f) == 1;
+  }
+ }
 
  /// Return the `i`-th basis element as a Fock state
  /**
    @param i Index of the basis state
    @return Fock state
  */
- fock_state_t get_fock_state(int i) const { return fock_states[i]; }
+ fock_state_t get_fock_state(uint64_t i) const { return fock_states[i]; }
 
  /// Return all basis Fock states in this subspace as `std::vector`
  /**
@@ -245,10 +315,28 @@ class sub_hilbert_space {
  // The list of all Fock states
  std::vector<fock_state_t> fock_states;
 
- // Reverse map to quickly find the index of a state.
+ // Reverse lookup strategy (see the class documentation)
+ enum class lookup_t { ranking, sorted, map };
+ lookup_t lookup = lookup_t::sorted;
+
+ // For lookup_t::ranking : the subspace is made of *all* the states with ranking_n_particles bits set
+ // among the bits of ranking_modes (the lowest bits), stored in increasing order.
+ int ranking_n_particles = 0;
+ fock_state_t ranking_modes = 0;
+
+ // Reverse map to quickly find the index of a state, used only for lookup_t::map.
  // The boost::container::flat_map is implemented as an ordered vector,
  // hence it is slow to insert (we don't care) but fast to look up (we do it a lot)
- boost::container::flat_map<fock_state_t, int> fock_to_index;
+ boost::container::flat_map<fock_state_t, uint64_t> fock_to_index;
+
+ // Switch to the general lookup_t::map strategy
+ void _build_map() {
+  lookup = lookup_t::map;
+  fock_to_index.clear();
+  for (auto f : fock_states) fock_to_index.insert(std::make_pair(f, static_cast<uint64_t>(fock_to_index.size())));
+ }
+
+ friend sub_hilbert_space make_particle_number_sector(fundamental_operator_set const& fops, int n_particles, int index);
 
  /// Return name of the HDF5 scheme
  /**
@@ -280,9 +368,40 @@ class sub_hilbert_space {
   h5_read(gr, "index", hs.index);
   h5_read(gr, "fock_states", hs.fock_states);
   hs.fock_to_index.clear();
-  for(auto f : hs.fock_states)
-   hs.fock_to_index.insert(std::make_pair(f, static_cast<int>(hs.fock_to_index.size())));
+  hs.lookup = (std::is_sorted(hs.fock_states.begin(), hs.fock_states.end()) &&
+               std::adjacent_find(hs.fock_states.begin(), hs.fock_states.end()) == hs.fock_states.end())
+                  ? lookup_t::sorted
+                  : lookup_t::map;
+  if (hs.lookup == lookup_t::map) hs._build_map();
  }
 
 };
+
+/// Occupation constraint: a group of fundamental operators and the total number of particles it holds
+using occupation_constraint_t = std::pair<std::vector<fundamental_operator_set::indices_t>, int>;
+
+/// Build a sector of the Hilbert space with fixed occupation numbers
+/**
+  The basis Fock states of the sector are enumerated directly, combination by combination,
+  so the full Hilbert space is never constructed. This allows to work with a few particles in
+  many orbitals, as long as `fops.size()` does not exceed the width of [[fock_state_t]].
+  The groups of the constraints must be disjoint; the occupations of the operators
+  not mentioned in any group are left free. The basis states are stored in increasing order.
+
+  @param fops Fundamental operator set used to construct the full Hilbert space
+  @param constraints List of (group of index sequences, number of particles in the group)
+  @param index Index of the new subspace within the full Hilbert space
+  @return The sector
+*/
+sub_hilbert_space make_sector(fundamental_operator_set const& fops, std::vector<occupation_constraint_t> const& constraints,
+                              int index = -1);
+
+/// Build the sector of the Hilbert space with a fixed total number of particles
+/**
+  @param fops Fundamental operator set used to construct the full Hilbert space
+  @param n_particles Total number of particles
+  @param index Index of the new subspace within the full Hilbert space
+  @return The sector
+*/
+sub_hilbert_space make_particle_number_sector(fundamental_operator_set const& fops, int n_particles, int index = -1);
 }}
@@ -39,6 +39,51 @@
 namespace triqs {
 namespace hilbert_space {
 
+namespace details {
+
+ // A monomial of canonical operators acting on Fock states, compiled into bit masks
+ // Fock state convention:
+ // |0,...,k> = C^+_0 ... C^+_k |0>
+ // Operator monomial convention:
+ // C^+_0 ... C^+_i ... C_j  ... C_0
+ struct compiled_monomial {
+  uint64_t d_mask = 0, dag_mask = 0, d_count_mask = 0, dag_count_mask = 0;
+
+  compiled_monomial() = default;
+
+  template <typename Monomial> compiled_monomial(Monomial const& monomial, fundamental_operator_set const& fops) {
+   std::vector<int> dag, ndag;
+   for (auto const& canonical_op : monomial) {
+    (canonical_op.dagger ? dag : ndag).push_back(fops[canonical_op.indices]);
+    (canonical_op.dagger ? dag_mask : d_mask) |= (uint64_t(1) << fops[canonical_op.indices]);
+   }
+   auto compute_count_mask = [](std::vector<int> const& d) {
+    uint64_t mask = 0;
+    bool is_on = (d.size() % 2 == 1);
+    for (int i = 0; i < fock_state_max_n_bits; ++i) {
+     if (std::find(begin(d), end(d), i) != end(d))
+      is_on = !is_on;
+     else if (is_on)
+      mask |= (uint64_t(1) << i);
+    }
+    return mask;
+   };
+   d_count_mask = compute_count_mask(ndag);
+   dag_count_mask = compute_count_mask(dag);
+  }
+
+  // Act on f : return false if the result vanishes, otherwise replace f by the resulting state and set the sign
+  bool apply(fock_state_t& f, bool& sign_is_minus) const {
+   if ((f & d_mask) != d_mask) return false;
+   fock_state_t f2 = f & ~d_mask;
+   if (((f2 ^ dag_mask) & dag_mask) != dag_mask) return false;
+   f = ~(~f2 & ~dag_mask);
+   sign_is_minus = parity_number_of_bits((f2 & d_count_mask) ^ (f & dag_count_mask));
+   return true;
+  }
+ };
+}
+
 /*
    If UseMap is false, the constructor takes two arguments:
 
@@ -64,16 +109,11 @@ namespace hilbert_space {
  */
 template <typename HilbertType, typename ScalarType = double, bool UseMap = false> class imperative_operator {
 
- // Fock state convention:
- // |0,...,k> = C^+_0 ... C^+_k |0>
- // Operator monomial convention:
- // C^+_0 ... C^+_i ... C_j  ... C_0
-
  using scalar_t = ScalarType;
 
  struct one_term_t {
   scalar_t coeff;
-  uint64_t d_mask, dag_mask, d_count_mask, dag_count_mask;
+  details::compiled_monomial masks;
  };
  std::vector<one_term_t> all_terms;
 
@@ -99,30 +139,13 @@ template <typename HilbertType, typename ScalarType = double, bool UseMap = fals
   sub_spaces = sub_spaces_set;
   hilbert_map = hmap;
   if ((hilbert_map.size() == 0) != !UseMap) TRIQS_RUNTIME_ERROR << "Internal error";
+  if (fops.size() > fock_state_max_n_bits)
+   TRIQS_RUNTIME_ERROR << "Too many fundamental operators (" << fops.size() << "), at most " << fock_state_max_n_bits
+                       << " are supported";
 
   // The goal here is to have a transcription of the many_body_operator in terms
-  // of simple vectors (maybe the code below could be more elegant)
-  for (auto const &term : op) {
-   std::vector<int> dag, ndag;
-   uint64_t d_mask = 0, dag_mask = 0;
-   for (auto const &canonical_op : term.monomial) {
-    (canonical_op.dagger ? dag : ndag).push_back(fops[canonical_op.indices]);
-    (canonical_op.dagger ? dag_mask : d_mask) |= (uint64_t(1) << fops[canonical_op.indices]);
-   }
-   auto compute_count_mask = [](std::vector<int> const &d) {
-    uint64_t mask = 0;
-    bool is_on = (d.size() % 2 == 1);
-    for (int i = 0; i < 64; ++i) {
-     if (std::find(begin(d), end(d), i) != end(d))
-      is_on = !is_on;
-     else if (is_on)
-      mask |= (uint64_t(1) << i);
-    }
-    return mask;
-   };
-   uint64_t d_count_mask = compute_count_mask(ndag), dag_count_mask = compute_count_mask(dag);
-   all_terms.push_back(one_term_t{scalar_t(term.coef), d_mask, dag_mask, d_count_mask, dag_count_mask});
-  }
+  // of simple vectors
+  for (auto const &term : op) all_terms.push_back(one_term_t{scalar_t(term.coef), {term.monomial, fops}});
  }
 
  /// Apply a callable object to each coefficient of the operator by reference
@@ -147,17 +170,6 @@ template <typename HilbertType, typename ScalarType = double, bool UseMap = fals
   return StateType(st.get_hilbert());
  }
 
- static bool parity_number_of_bits(uint64_t v) {
-  // http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetNaive
-  // v ^= v >> 16;
-  // only ok until 16 orbitals ! assert this or put the >> 16
-  v ^= v >> 8;
-  v ^= v >> 4;
-  v ^= v >> 2;
-  v ^= v >> 1;
-  return v & 0x01;
- }
-
   // Forward the call to the coefficient
 #ifdef GCC_BUG_41933_WORKAROUND
  template<typename... Args>
@@ -206,16 +218,13 @@ template <typename HilbertType, typename ScalarType = double, bool UseMap = fals
   for (int i = 0; i < all_terms.size(); ++i) { // loop over monomials
    auto M = all_terms[i];
 #ifdef GCC_BUG_41933_WORKAROUND
-   foreach(st, [M, &target_st,hs,args_tuple](int i, typename StateType::value_type amplitude) {
+   foreach(st, [M, &target_st,hs,args_tuple](uint64_t i, typename StateType::value_type amplitude) {
 #else
-   foreach(st, [M, &target_st,hs,args...](int i, typename StateType::value_type amplitude) {
+   foreach(st, [M, &target_st,hs,args...](uint64_t i, typename StateType::value_type amplitude) {
 #endif
-    fock_state_t f2 = hs.get_fock_state(i);
-    if ((f2 & M.d_mask) != M.d_mask) return;
-    f2 &= ~M.d_mask;
-    if (((f2 ^ M.dag_mask) & M.dag_mask) != M.dag_mask) return;
-    fock_state_t f3 = ~(~f2 & ~M.dag_mask);
-    auto sign_is_minus = parity_number_of_bits((f2 & M.d_count_mask) ^ (f3 & M.dag_count_mask));
+    fock_state_t f3 = hs.get_fock_state(i);
+    bool sign_is_minus;
+    if (!M.masks.apply(f3, sign_is_minus)) return;
     // update state vector in target Hilbert space
     auto ind = target_st.get_hilbert().get_state_index(f3);
 #ifdef GCC_BUG_41933_WORKAROUND
@@ -0,0 +1,339 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2013, P. Seth, I. Krivenko, M. Ferrero and O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <vector>
+#include <cmath>
+#include <random>
+#include <exception>
+#include <algorithm>
+#include <triqs/arrays.hpp>
+#include <triqs/arrays/blas_lapack/dot.hpp>
+#include <triqs/arrays/blas_lapack/axpy.hpp>
+#include <triqs/arrays/linalg/eigenelements.hpp>
+#include "./sparse_hamiltonian.hpp"
+#include "./space_partition.hpp"
+
+namespace triqs {
+namespace hilbert_space {
+
+/// Some eigenvalues and eigenvectors of a Hermitian matrix
+template <typename ScalarType> struct eigensystem {
+ /// Eigenvalues, in increasing order
+ std::vector<double> eigenvalues;
+ /// Normalized eigenvectors, in the order of the eigenvalues
+ std::vector<arrays::vector<ScalarType>> eigenvectors;
+};
+
+/// Lanczos eigensolver and Krylov propagator for a sparse Hermitian matrix
+/**
+  Both algorithms build a Krylov basis `v_0, ..., v_{m-1}` of the matrix `H` by the Lanczos recursion,
+  with full reorthogonalization, and work with the tridiagonal projection of `H` onto this basis.
+
+  - [[krylov_solver_lowest_eigenstates]] returns the lowest Ritz pairs once their residuals are below the tolerance,
+    restarting from the current Ritz vectors if the maximal dimension of the Krylov basis is reached.
+    A single Krylov space contains only one vector of each degenerate eigenspace.
+  - [[krylov_solver_exp_minus_tau_h]] computes `exp(-tau H) psi`, splitting `tau` into smaller steps
+    if the maximal dimension of the Krylov basis is not enough.
+
+  The Krylov basis and the work vector are allocated once, at construction, and reused by all calls;
+  the matrix-vector products are those of [[csr_matrix]]. A solver is not thread safe: use one solver per thread.
+
+  @tparam ScalarType Type of the matrix elements, normally `double` or `std::complex<double>`
+  @include triqs/hilbert_space/krylov.hpp
+ */
+template <typename ScalarType = double> class krylov_solver {
+
+ public:
+ /// Accessor to `ScalarType` template parameter
+ using scalar_t = ScalarType;
+ /// Vector type
+ using vector_t = arrays::vector<ScalarType>;
+
+ /// Construct a solver for a matrix
+ /**
+   @param h Hermitian matrix; must outlive the solver
+   @param max_krylov_dim Maximal dimension of the Krylov basis
+   @param tolerance Tolerance on the residuals (eigenstates) or on the norm of the error (propagation), relative to the norm of the initial vector
+  */
+ krylov_solver(csr_matrix<ScalarType> const& h, int max_krylov_dim = 100, double tolerance = 1e-10)
+    : h(&h),
+      dim(h.n_rows),
+      max_krylov_dim(std::max<uint64_t>(1, std::min<uint64_t>(max_krylov_dim, h.n_rows))),
+      tolerance(tolerance),
+      basis(this->max_krylov_dim + 1, dim),
+      w(dim) {
+  alpha.reserve(this->max_krylov_dim);
+  beta.reserve(this->max_krylov_dim);
+ }
+
+ /// Lowest eigenvalues and eigenvectors, from a random initial vector
+ /**
+   @param n_states Number of requested eigenstates
+   @return The eigensystem
+  */
+ eigensystem<ScalarType> lowest_eigenstates(int n_states = 1) {
+  vector_t v0(dim);
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> distr(-1, 1);
+  for (uint64_t i = 0; i < dim; ++i) v0(i) = distr(gen);
+  return lowest_eigenstates(n_states, v0);
+ }
+
+ /// Lowest eigenvalues and eigenvectors
+ /**
+   Only the eigenstates which are not orthogonal to `v0` can be found.
+   Fewer eigenstates are returned if the Krylov space of `v0` is smaller than `n_states`.
+
+   @param n_states Number of requested eigenstates
+   @param v0 Initial vector
+   @return The eigensystem
+  */
+ eigensystem<ScalarType> lowest_eigenstates(int n_states, vector_t const& v0) {
+  eigensystem<ScalarType> res;
+  if (dim == 0 || n_states <= 0) return res;
+  n_states = std::min<uint64_t>(n_states, dim);
+
+  vector_t v = v0;
+  for (int restart = 0; restart < max_restarts; ++restart) {
+   if (start(v) == 0) TRIQS_RUNTIME_ERROR << "krylov_solver : the initial vector is zero";
+   while (true) {
+    bool invariant = !step();
+    int m = alpha.size();
+    if (!invariant && m < max_krylov_dim && (m < n_states || m % check_period != 0)) continue;
+    diagonalize(m);
+    int n = std::min(n_states, m);
+    bool converged = true;
+    for (int k = 0; k < n; ++k) converged &= (invariant || std::abs(beta.back() * T(k, m - 1)) < tolerance);
+    if (converged || invariant || m == max_krylov_dim) {
+     res.eigenvalues.clear();
+     res.eigenvectors.clear();
+     for (int k = 0; k < n; ++k) {
+      res.eigenvalues.push_back(ritz_values(k));
+      res.eigenvectors.push_back(combine(m, [this, k](int i) { return T(k, i); }));
+     }
+     if (converged || invariant) return res;
+     // Restart from the sum of the current Ritz vectors
+     v = res.eigenvectors[0];
+     for (int k = 1; k < n; ++k) v += res.eigenvectors[k];
+     break;
+    }
+   }
+  }
+  TRIQS_RUNTIME_ERROR << "krylov_solver : the Lanczos algorithm did not converge after " << max_restarts << " restarts";
+ }
+
+ /// Compute `exp(-tau H) psi`
+ /**
+   @param tau Imaginary time
+   @param psi Initial vector
+   @return `exp(-tau H) psi`
+  */
+ vector_t exp_minus_tau_h(double tau, vector_t const& psi) {
+  vector_t res = psi;
+  exp_minus_tau_h_in_place(tau, res);
+  return res;
+ }
+
+ /// Replace `psi` by `exp(-tau H) psi`
+ /**
+   @param tau Imaginary time
+   @param psi Initial vector, overwritten with the result
+  */
+ void exp_minus_tau_h_in_place(double tau, vector_t& psi) {
+  if (tau < 0) TRIQS_RUNTIME_ERROR << "krylov_solver : exp(-tau H) requires tau >= 0, got tau = " << tau;
+  double t = 0, dt = tau;
+  while (t < tau) {
+   dt = std::min(dt, tau - t);
+   if (exp_step(dt, psi))
+    t += dt;
+   else if ((dt /= 2) < tau * 1e-12)
+    TRIQS_RUNTIME_ERROR << "krylov_solver : the Krylov propagation did not converge, increase max_krylov_dim";
+  }
+ }
+
+ private:
+ csr_matrix<ScalarType> const* h;
+ uint64_t dim;
+ int max_krylov_dim;
+ double tolerance;
+ enum { check_period = 5, max_restarts = 100 };
+
+ // Krylov basis (one vector per row), work vector, tridiagonal matrix
+ arrays::matrix<ScalarType> basis;
+ vector_t w;
+ std::vector<double> alpha, beta;
+ arrays::matrix<double> T;
+ arrays::array<double, 1> ritz_values;
+ arrays::linalg::eigenelements_worker<double> eig_worker;
+
+ static double norm(vector_t const& v) { return std::sqrt(std::abs(arrays::dotc(v, v))); }
+
+ // Start a Krylov basis from v; return the norm of v
+ double start(vector_t const& v) {
+  alpha.clear();
+  beta.clear();
+  double nv = norm(v);
+  if (nv != 0)
+   for (uint64_t i = 0; i < dim; ++i) basis(0, i) = v(i) / nv;
+  return nv;
+ }
+
+ // Add a Lanczos vector to the basis; return false if the Krylov space is invariant under H
+ bool step() {
+  using arrays::range;
+  int j = alpha.size();
+  auto vj = basis(j, range());
+  h->apply(vj, w);
+  alpha.push_back(std::real(arrays::dotc(vj, w)));
+  // Full reorthogonalization (classical Gram-Schmidt), which includes the three-term recursion
+  for (int k = 0; k <= j; ++k) {
+   auto vk = basis(k, range());
+   arrays::blas::axpy(-arrays::dotc(vk, w), vk, w);
+  }
+  beta.push_back(norm(w));
+  if (j + 1 == dim || beta.back() <= 1e-12 * std::max(1.0, std::abs(alpha.back()))) return false;
+  if (j + 1 < max_krylov_dim) {
+   auto vj1 = basis(j + 1, range());
+   for (uint64_t i = 0; i < dim; ++i) vj1(i) = w(i) / beta.back();
+  }
+  return true;
+ }
+
+ // Diagonalize the tridiagonal matrix of size m : the eigenvectors are the rows of T
+ void diagonalize(int m) {
+  T.resize(m, m);
+  T() = 0;
+  for (int i = 0; i < m; ++i) {
+   T(i, i) = alpha[i];
+   if (i + 1 < m) T(i, i + 1) = T(i + 1, i) = beta[i];
+  }
+  auto r = eig_worker.eigenelements(T);
+  ritz_values = r.first;
+  T = r.second;
+ }
+
+ // The vector sum_i c(i) v_i over the first m Krylov vectors
+ template <typename C> vector_t combine(int m, C c) {
+  using arrays::range;
+  vector_t r(dim);
+  r() = 0;
+  for (int i = 0; i < m; ++i) arrays::blas::axpy(scalar_t(c(i)), basis(i, range()), r);
+  return r;
+ }
+
+ // psi -> exp(-dt H) psi; return false if the Krylov basis is too small
+ bool exp_step(double dt, vector_t& psi) {
+  double npsi = start(psi);
+  if (npsi == 0) return true;
+  std::vector<double> c;
+  while (true) {
+   bool invariant = !step();
+   int m = alpha.size();
+   diagonalize(m);
+   // exp(-dt T) e_0 in the Krylov basis
+   c.assign(m, 0);
+   for (int l = 0; l < m; ++l) {
+    double x = std::exp(-dt * ritz_values(l)) * T(l, 0);
+    for (int i = 0; i < m; ++i) c[i] += x * T(l, i);
+   }
+   bool converged = invariant || std::abs(beta.back() * c[m - 1]) < tolerance;
+   if (converged) {
+    psi = combine(m, [&c, npsi](int i) { return npsi * c[i]; });
+    return true;
+   }
+   if (m == max_krylov_dim) return false;
+  }
+ }
+};
+
+/// Lowest eigenstates of several matrices
+/**
+  The matrices, e.g. the blocks of a Hamiltonian in its invariant subspaces, are processed in parallel (OpenMP),
+  each with its own [[krylov_solver]].
+
+  @tparam ScalarType Type of the matrix elements, normally `double` or `std::complex<double>`
+  @param blocks Hermitian matrices
+  @param n_states Number of requested eigenstates in each block
+  @param max_krylov_dim Maximal dimension of the Krylov basis
+  @param tolerance Tolerance on the residuals
+  @return The eigensystem of each block
+ */
+template <typename ScalarType>
+std::vector<eigensystem<ScalarType>> lowest_eigenstates(std::vector<csr_matrix<ScalarType>> const& blocks, int n_states = 1,
+                                                        int max_krylov_dim = 100, double tolerance = 1e-10) {
+ std::vector<eigensystem<ScalarType>> res(blocks.size());
+ std::vector<std::exception_ptr> errors(blocks.size());
+#pragma omp parallel for schedule(dynamic)
+ for (long b = 0; b < long(blocks.size()); ++b) {
+  try {
+   res[b] = krylov_solver<ScalarType>(blocks[b], max_krylov_dim, tolerance).lowest_eigenstates(n_states);
+  } catch (...) {
+   errors[b] = std::current_exception();
+  }
+ }
+ for (auto const& e : errors)
+  if (e) std::rethrow_exception(e);
+ return res;
+}
+
+/// Compute `exp(-tau H) psi` for several blocks of a matrix
+/**
+  The blocks, e.g. those of a Hamiltonian in its invariant subspaces, are processed in parallel (OpenMP),
+  each with its own [[krylov_solver]].
+
+  @tparam ScalarType Type of the matrix elements, normally `double` or `std::complex<double>`
+  @param blocks Hermitian matrices
+  @param tau Imaginary time
+  @param psi Initial vector in each block, replaced by the result
+  @param max_krylov_dim Maximal dimension of the Krylov basis
+  @param tolerance Tolerance on the norm of the error
+ */
+template <typename ScalarType>
+void exp_minus_tau_h_in_place(std::vector<csr_matrix<ScalarType>> const& blocks, double tau,
+                              std::vector<arrays::vector<ScalarType>>& psi, int max_krylov_dim = 100, double tolerance = 1e-10) {
+ if (psi.size() != blocks.size()) TRIQS_RUNTIME_ERROR << "exp_minus_tau_h_in_place : one vector per block is required";
+ std::vector<std::exception_ptr> errors(blocks.size());
+#pragma omp parallel for schedule(dynamic)
+ for (long b = 0; b < long(blocks.size()); ++b) {
+  try {
+   krylov_solver<ScalarType>(blocks[b], max_krylov_dim, tolerance).exp_minus_tau_h_in_place(tau, psi[b]);
+  } catch (...) {
+   errors[b] = std::current_exception();
+  }
+ }
+ for (auto const& e : errors)
+  if (e) std::rethrow_exception(e);
+}
+
+/// Build the invariant subspaces found by a [[space_partition]]
+/**
+  @param SP Space partition
+  @param hs Hilbert space the partition was built on
+  @return The invariant subspaces, with their basis states in increasing order
+ */
+template <typename StateType, typename OperatorType, typename HilbertSpace>
+std::vector<sub_hilbert_space> make_sub_hilbert_spaces(space_partition<StateType, OperatorType>& SP, HilbertSpace const& hs) {
+ std::vector<sub_hilbert_space> res;
+ for (uint64_t n = 0; n < SP.n_subspaces(); ++n) res.emplace_back(n);
+ foreach(SP, [&](uint64_t st, uint64_t sp) { res[sp].add_fock_state(hs.get_fock_state(st)); });
+ return res;
+}
+}}
@@ -23,7 +23,14 @@
 
 #include <set>
 #include <map>
+#include <vector>
 #include <utility>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <exception>
+#include <boost/container/flat_map.hpp>
 #include <triqs/utility/numeric_ops.hpp>
 #include <boost/pending/disjoint_sets.hpp>
 
@@ -37,6 +44,11 @@ namespace hilbert_space {
   For a detailed description of the algorithm see
   `Computer Physics Communications 200, March 2016, 274-284 <http://dx.doi.org/10.1016/j.cpc.2015.10.023>`_ (section 4.2).
 
+  The operators are applied to the basis states in parallel (OpenMP), each thread using its own work state
+  and collecting its results in plain vectors, which are merged at the end.
+  The operators must therefore be safe to apply concurrently, as [[imperative_operator]] is.
+  An exception thrown by an operator is rethrown once all the threads are done.
+
   @tparam StateType Many-body state type, must model [[statevector_concept]]
   @tparam OperatorType Imperative operator type, must provide `StateType operator()(StateType const&)`
  */
@@ -44,7 +56,7 @@ template <typename StateType, typename OperatorType> class space_partition {
 
  public:
  /// Index of a basis Fock state/subspace
- using index_t = uint32_t;
+ using index_t = uint64_t;
  /// Accessor to `StateType` template parameter
  using state_t = StateType;
  /// Accessor to `OperatorType` template parameter
@@ -54,8 +66,10 @@ template <typename StateType, typename OperatorType> class space_partition {
  /// Connections between subspaces represented as a set of (from-index,to-index) pair
  using block_mapping_t = std::set<std::pair<index_t,index_t>>;
  /// Non-zero matrix elements of an operator represented as a mapping (from-state,to-state) -> value
- using matrix_element_map_t =
-     std::map<std::pair<index_t,index_t>, typename state_t::value_type>;
+ /**
+   The map is a sorted vector of ((from-state,to-state), value) (COO format), ordered by from-state first.
+  */
+ using matrix_element_map_t = boost::container::flat_map<std::pair<index_t, index_t>, typename state_t::value_type>;
 
  /// Perform Phase I of the automatic partition algorithm
  /**
@@ -66,26 +80,29 @@ template <typename StateType, typename OperatorType> class space_partition {
    @param store_matrix_elements Should we store the non-vanishing matrix elements of the Hamiltonian?
   */
  space_partition(state_t const& st, operator_t const& H, bool store_matrix_elements = true)
-    : tmp_state(make_zero_state(st)), subspaces(st.size()){
-  auto size = tmp_state.size();
-
-  // Iteration over all initial basis states
-  for (index_t i = 0; i < size; ++i) {
-   tmp_state(i) = amplitude_t(1.0);
-   state_t final_state = H(tmp_state);
-
-   // Iterate over non-zero final amplitudes
-   foreach(final_state, [&](index_t f, amplitude_t amplitude) {
-    using triqs::utility::is_zero;
-    if (is_zero(amplitude)) return;
-    auto i_subspace = subspaces.find_set(i);
-    auto f_subspace = subspaces.find_set(f);
-    if (i_subspace != f_subspace) subspaces.link(i_subspace, f_subspace);
-
-    if (store_matrix_elements) matrix_elements[std::make_pair(i, f)] = amplitude;
-   });
-   tmp_state(i) = amplitude_t(0.);
-  }
+    : tmp_state(make_zero_state(st)), subspaces(st.size()) {
+
+  matrix_element_vector_t elements;
+  index_t size = st.size();
+
+  // Each thread keeps its connections as a spanning forest of the basis states (O(size) instead of O(nnz)),
+  // merged into the subspaces at the end
+  for_each_nonzero_element(H, [&](index_t i, index_t f, amplitude_t amplitude, local_buffers_t& buf) {
+   if (i != f) {
+    if (!buf.forest) buf.forest.reset(new boost::disjoint_sets_with_storage<>(size));
+    buf.forest->union_set(i, f);
+   }
+   if (store_matrix_elements) buf.elements.emplace_back(std::make_pair(i, f), amplitude);
+  }, [&](local_buffers_t& buf) {
+   if (buf.forest)
+    for (index_t n = 0; n < size; ++n) {
+     index_t r = buf.forest->find_set(n);
+     if (r != n) subspaces.union_set(n, r);
+    }
+   elements.insert(elements.end(), buf.elements.begin(), buf.elements.end());
+  });
+
+  matrix_elements = make_matrix_element_map(std::move(elements));
 
   _update_index();
  }
@@ -106,34 +123,31 @@ template <typename StateType, typename OperatorType> class space_partition {
  std::pair<matrix_element_map_t, matrix_element_map_t> merge_subspaces(operator_t const& Cd, operator_t const& C,
                                                                        bool store_matrix_elements = true) {
 
-  matrix_element_map_t Cd_elements, C_elements;
-  std::multimap<index_t,index_t> Cd_connections, C_connections;
-
-  auto size = tmp_state.size();
-
-  // Fill connection multimaps
-  for (index_t i = 0; i < size; ++i) {
-   tmp_state(i) = amplitude_t(1.0);
-   auto i_subspace = subspaces.find_set(i);
-
-   auto fill_conn = [this,i,i_subspace,store_matrix_elements]
-                    (operator_t const& op, std::multimap<index_t,index_t> & conn, matrix_element_map_t & elem) {
-    state_t final_state = op(tmp_state);
-    // Iterate over non-zero final amplitudes
-    foreach(final_state, [&](index_t f, amplitude_t amplitude) {
-     using triqs::utility::is_zero;
-     if (is_zero(amplitude)) return;
-     auto f_subspace = subspaces.find_set(f);
-     conn.insert({i_subspace,f_subspace});
-     if (store_matrix_elements) elem[{i, f}] = amplitude;
-    });
-   };
+  // Connections between subspaces (subspace indices) and matrix elements
+  std::vector<std::pair<index_t, index_t>> Cd_conn_v, C_conn_v;
+  matrix_element_vector_t Cd_elem_v, C_elem_v;
+
+  auto fill_conn = [this, store_matrix_elements](operator_t const& op, std::vector<std::pair<index_t, index_t>>& conn,
+                                                  matrix_element_vector_t& elem) {
+   for_each_nonzero_element(op, [&](index_t i, index_t f, amplitude_t amplitude, local_buffers_t& buf) {
+    buf.links.emplace_back(subspace_index[i], subspace_index[f]);
+    if (store_matrix_elements) buf.elements.emplace_back(std::make_pair(i, f), amplitude);
+   }, [&](local_buffers_t& buf) {
+    sort_unique(buf.links);
+    conn.insert(conn.end(), buf.links.begin(), buf.links.end());
+    elem.insert(elem.end(), buf.elements.begin(), buf.elements.end());
+   });
+   sort_unique(conn);
+  };
 
-   fill_conn(Cd,Cd_connections,Cd_elements);
-   fill_conn(C,C_connections,C_elements);
+  fill_conn(Cd, Cd_conn_v, Cd_elem_v);
+  fill_conn(C, C_conn_v, C_elem_v);
 
-   tmp_state(i) = amplitude_t(0.);
-  }
+  std::multimap<index_t, index_t> Cd_connections(Cd_conn_v.begin(), Cd_conn_v.end());
+  std::multimap<index_t, index_t> C_connections(C_conn_v.begin(), C_conn_v.end());
+
+  // Merge two subspaces, given by their index before the merge
+  auto merge = [this](index_t sp1, index_t sp2) { subspaces.union_set(subspace_representative[sp1], subspace_representative[sp2]); };
 
   // 'Zigzag' traversal algorithm
   while(!Cd_connections.empty()) {
@@ -149,7 +163,7 @@ template <typename StateType, typename OperatorType> class space_partition {
    // - Merges lower_subspace with all subspaces generated from lower_subspace by application of (C C^+)^(2*n).
    // - Merges upper_subspace with all subspaces generated from upper_subspace by application of (C^+ C)^(2*n).
    std::function<void(index_t,bool)> zigzag_traversal =
-    [this,lower_subspace,upper_subspace,&Cd_connections,&C_connections,&zigzag_traversal]
+    [lower_subspace,upper_subspace,&Cd_connections,&C_connections,&zigzag_traversal,&merge]
     (index_t i_subspace,        // find all connections starting from i_subspace
      bool upwards               // if true, C^+ connection, otherwise C connection
     ){
@@ -160,8 +174,8 @@ template <typename StateType, typename OperatorType> class space_partition {
      auto f_subspace = it->second;
      (upwards ? Cd_connections : C_connections).erase(it);
 
-     if(upwards) subspaces.link(f_subspace, upper_subspace);
-     else        subspaces.link(f_subspace, lower_subspace);
+     if(upwards) merge(f_subspace, upper_subspace);
+     else        merge(f_subspace, lower_subspace);
 
      // Recursively apply to all found f_subspace's with a 'flipped' direction
      zigzag_traversal(f_subspace,!upwards);
@@ -174,14 +188,14 @@ template <typename StateType, typename OperatorType> class space_partition {
 
   _update_index();
 
-  return std::make_pair(Cd_elements, C_elements);
+  return std::make_pair(make_matrix_element_map(std::move(Cd_elem_v)), make_matrix_element_map(std::move(C_elem_v)));
  }
 
  /// Return the number of subspaces in the partition
  /**
    @return Number of invariant subspaces
   */
- index_t n_subspaces() const { return representative_to_index.size(); }
+ index_t n_subspaces() const { return subspace_representative.size(); }
 
  /// Apply a callable object to all basis Fock states in a given space partition
  /**
@@ -201,7 +215,7 @@ template <typename StateType, typename OperatorType> class space_partition {
    @param basis_state Index of a basis Fock state
    @return Index of the found invariant subspace
   */
- index_t lookup_basis_state(index_t basis_state) { return representative_to_index[subspaces.find_set(basis_state)]; }
+ index_t lookup_basis_state(index_t basis_state) const { return subspace_index[basis_state]; }
 
  /// Access to matrix elements of the Hamiltonian
  /**
@@ -217,50 +231,117 @@ template <typename StateType, typename OperatorType> class space_partition {
   */
  block_mapping_t find_mappings(operator_t const& op, bool diagonal_only = false) {
 
-  block_mapping_t mapping;
+  std::vector<std::pair<index_t, index_t>> mapping;
 
-  // Iteration over all initial basis states
-  for (index_t i = 0; i < tmp_state.size(); ++i) {
-   state_t initial_state = tmp_state;
-   initial_state(i) = amplitude_t(1.0);
-   auto i_subspace = subspaces.find_set(i);
+  for_each_nonzero_element(op, [&](index_t i, index_t f, amplitude_t, local_buffers_t& buf) {
+   auto i_subspace = subspace_index[i], f_subspace = subspace_index[f];
+   if ((!diagonal_only) || i_subspace == f_subspace) buf.links.emplace_back(i_subspace, f_subspace);
+  }, [&](local_buffers_t& buf) {
+   sort_unique(buf.links);
+   mapping.insert(mapping.end(), buf.links.begin(), buf.links.end());
+  });
 
-   state_t final_state = op(initial_state);
+  return block_mapping_t(mapping.begin(), mapping.end());
+ }
 
-   // Iterate over non-zero final amplitudes
-   foreach(final_state, [&](index_t f, amplitude_t amplitude) {
-    using triqs::utility::is_zero;
-    if (is_zero(amplitude)) return;
-    auto f_subspace = subspaces.find_set(f);
-    if((!diagonal_only) || i_subspace==f_subspace)
-      mapping.insert(std::make_pair(representative_to_index[i_subspace],
-                                    representative_to_index[f_subspace]));
-   });
+ private:
+ using matrix_element_vector_t = std::vector<std::pair<std::pair<index_t, index_t>, amplitude_t>>;
+
+ // Per-thread results of for_each_nonzero_element
+ struct local_buffers_t {
+  std::vector<std::pair<index_t, index_t>> links;
+  matrix_element_vector_t elements;
+  std::unique_ptr<boost::disjoint_sets_with_storage<>> forest; // Phase I : connected basis states
+ };
+
+ // Apply op to all basis states, and call F(i, f, amplitude, buffers) for all non-zero <f|op|i>.
+ // The loop over i is run in parallel : F must only write into the thread local buffers,
+ // which are passed to Merge(buffers) one thread at a time at the end.
+ // An exception can not leave the parallel region : the first one is kept, the other iterations are skipped,
+ // and it is rethrown after the region.
+ template <typename F, typename Merge> void for_each_nonzero_element(operator_t const& op, F f_elem, Merge merge) const {
+  index_t size = tmp_state.size();
+  std::exception_ptr error;
+  std::atomic<bool> failed(false);
+  auto keep_error = [&]() {
+#pragma omp critical(space_partition_error)
+   if (!error) error = std::current_exception();
+   failed = true;
+  };
+#pragma omp parallel
+  {
+   std::unique_ptr<state_t> initial_state;
+   local_buffers_t buf;
+   try {
+    initial_state.reset(new state_t(make_zero_state(tmp_state)));
+   } catch (...) {
+    keep_error();
+   }
+#pragma omp for schedule(dynamic, 64)
+   for (index_t i = 0; i < size; ++i) {
+    if (failed) continue;
+    try {
+     (*initial_state)(i) = amplitude_t(1.0);
+     state_t final_state = op(*initial_state);
+     (*initial_state)(i) = amplitude_t(0.);
+     // Iterate over non-zero final amplitudes
+     foreach(final_state, [&](index_t f, amplitude_t amplitude) {
+      using triqs::utility::is_zero;
+      if (!is_zero(amplitude)) f_elem(i, f, amplitude, buf);
+     });
+    } catch (...) {
+     keep_error();
+    }
+   }
+#pragma omp critical
+   {
+    try {
+     if (!failed) merge(buf);
+    } catch (...) {
+     keep_error();
+    }
+   }
   }
+  if (error) std::rethrow_exception(error);
+ }
 
-  return mapping;
+ template <typename V> static void sort_unique(V& v) {
+  std::sort(v.begin(), v.end());
+  v.erase(std::unique(v.begin(), v.end()), v.end());
+ }
+
+ // Sort the collected elements and adopt them as a matrix_element_map_t
+ static matrix_element_map_t make_matrix_element_map(matrix_element_vector_t&& v) {
+  std::sort(v.begin(), v.end(), [](typename matrix_element_vector_t::value_type const& x,
+                                   typename matrix_element_vector_t::value_type const& y) { return x.first < y.first; });
+  return matrix_element_map_t(boost::container::ordered_unique_range, v.begin(), v.end());
  }
 
- private:
  void _update_index() {
-  auto p = subspaces.parents();
-  subspaces.compress_sets(p.begin(), p.end());  // parents are representatives
-  subspaces.normalize_sets(p.begin(), p.end()); // the representative has the smallest index in the set
-
-  // Update representative_to_index
-  representative_to_index.clear();
-  for (index_t n = 0; n < tmp_state.size(); ++n) {
-   representative_to_index.insert(std::make_pair(subspaces.find_set(n), representative_to_index.size()));
+  // Number the subspaces in the order of their smallest basis state
+  index_t size = tmp_state.size();
+  std::vector<index_t> root_to_index(size, index_t(-1));
+  subspace_index.resize(size);
+  subspace_representative.clear();
+  for (index_t n = 0; n < size; ++n) {
+   auto& k = root_to_index[subspaces.find_set(n)];
+   if (k == index_t(-1)) {
+    k = subspace_representative.size();
+    subspace_representative.push_back(n);
+   }
+   subspace_index[n] = k;
   }
  }
 
  // Temporary zero state
- mutable state_t tmp_state;
+ state_t tmp_state;
  // Subspaces
  boost::disjoint_sets_with_storage<> subspaces;
  // Matrix elements of the Hamiltonian
  matrix_element_map_t matrix_elements;
- // Map representative basis state to subspace index
- std::map<index_t, index_t> representative_to_index;
+ // Index of the subspace of each basis state
+ std::vector<index_t> subspace_index;
+ // A basis state (the smallest one) in each subspace
+ std::vector<index_t> subspace_representative;
 };
 }}
@@ -0,0 +1,333 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2013, P. Seth, I. Krivenko, M. Ferrero and O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <triqs/arrays.hpp>
+#include <triqs/utility/numeric_ops.hpp>
+#include "./imperative_operator.hpp"
+
+namespace triqs {
+namespace hilbert_space {
+
+/// Sparse matrix in the compressed sparse row (CSR) format, with 64-bit indices
+/**
+  The non-vanishing elements of row `i` are `values[k]`, in the columns `col_index[k]`,
+  for `row_ptr[i] <= k < row_ptr[i+1]`. Within a row, the columns are sorted.
+
+  @tparam ScalarType Type of the matrix elements, normally `double` or `std::complex<double>`
+  @include triqs/hilbert_space/sparse_hamiltonian.hpp
+ */
+template <typename ScalarType> struct csr_matrix {
+
+ /// Accessor to `ScalarType` template parameter
+ using value_type = ScalarType;
+
+ /// Number of rows
+ uint64_t n_rows = 0;
+ /// Number of columns
+ uint64_t n_cols = 0;
+ /// Position of the first element of each row in `col_index` and `values`, of size `n_rows + 1`
+ std::vector<uint64_t> row_ptr = {0};
+ /// Column of each non-vanishing element
+ std::vector<uint64_t> col_index;
+ /// Value of each non-vanishing element
+ arrays::vector<ScalarType> values;
+
+ /// Number of stored (non-vanishing) elements
+ /**
+   @return Number of stored elements
+  */
+ uint64_t nnz() const { return col_index.size(); }
+
+ /// Matrix-vector product `y = A x`
+ /**
+   The rows are processed in parallel (OpenMP).
+
+   @param x Vector of size `n_cols`
+   @param y Vector of size `n_rows`, overwritten
+  */
+ template <typename V1, typename V2> void apply(V1 const& x, V2& y) const {
+#pragma omp parallel for schedule(static)
+  for (long i = 0; i < long(n_rows); ++i) {
+   typename V2::value_type r = 0;
+   for (uint64_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) r += values(k) * x(col_index[k]);
+   y(i) = r;
+  }
+ }
+
+ /// Return the matrix as a dense `triqs::arrays::matrix`
+ /**
+   @return Dense matrix
+  */
+ arrays::matrix<ScalarType> to_dense() const {
+  arrays::matrix<ScalarType> m(n_rows, n_cols);
+  m() = 0;
+  for (uint64_t i = 0; i < n_rows; ++i)
+   for (uint64_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) m(i, col_index[k]) = values(k);
+  return m;
+ }
+
+ /// Return name of the HDF5 scheme
+ /**
+   @return Name of the scheme
+ */
+ friend std::string get_triqs_hdf5_data_scheme(csr_matrix const&) { return "csr_matrix"; }
+
+ /// Write a CSR matrix to an HDF5 group
+ /**
+   @param fg Parent HDF5 group to write the matrix to
+   @param name Name of the HDF5 subgroup to be created
+   @param m Matrix to be written
+ */
+ friend void h5_write(h5::group fg, std::string const& name, csr_matrix const& m) {
+  auto gr = fg.create_group(name);
+  gr.write_triqs_hdf5_data_scheme(m);
+  h5_write(gr, "n_rows", m.n_rows);
+  h5_write(gr, "n_cols", m.n_cols);
+  h5_write(gr, "row_ptr", m.row_ptr);
+  h5_write(gr, "col_index", m.col_index);
+  h5_write(gr, "values", m.values);
+ }
+
+ /// Read a CSR matrix from an HDF5 group
+ /**
+   @param fg Parent HDF5 group to read the matrix from
+   @param name Name of the HDF5 subgroup to be read
+   @param m Reference to a target matrix
+ */
+ friend void h5_read(h5::group fg, std::string const& name, csr_matrix& m) {
+  using h5::h5_read;
+  auto gr = fg.open_group(name);
+  h5_read(gr, "n_rows", m.n_rows);
+  h5_read(gr, "n_cols", m.n_cols);
+  h5_read(gr, "row_ptr", m.row_ptr);
+  h5_read(gr, "col_index", m.col_index);
+  h5_read(gr, "values", m.values);
+ }
+};
+
+/// Hamiltonian restricted to a symmetry sector
+/**
+  @tparam ScalarType Type of the matrix elements, normally `double` or `std::complex<double>`
+  @include triqs/hilbert_space/sparse_hamiltonian.hpp
+ */
+template <typename ScalarType> struct sector_hamiltonian {
+
+ /// Occupation of each group of operators (quantum numbers of the sector)
+ std::vector<int> occupations;
+ /// Basis of the sector
+ sub_hilbert_space space;
+ /// Matrix of the Hamiltonian in the basis `space`
+ csr_matrix<ScalarType> matrix;
+
+ /// Return name of the HDF5 scheme
+ /**
+   @return Name of the scheme
+ */
+ friend std::string get_triqs_hdf5_data_scheme(sector_hamiltonian const&) { return "sector_hamiltonian"; }
+
+ /// Write a sector to an HDF5 group
+ /**
+   @param fg Parent HDF5 group to write the sector to
+   @param name Name of the HDF5 subgroup to be created
+   @param s Sector to be written
+ */
+ friend void h5_write(h5::group fg, std::string const& name, sector_hamiltonian const& s) {
+  auto gr = fg.create_group(name);
+  gr.write_triqs_hdf5_data_scheme(s);
+  h5_write(gr, "occupations", s.occupations);
+  h5_write(gr, "space", s.space);
+  h5_write(gr, "matrix", s.matrix);
+ }
+
+ /// Read a sector from an HDF5 group
+ /**
+   @param fg Parent HDF5 group to read the sector from
+   @param name Name of the HDF5 subgroup to be read
+   @param s Reference to a target sector
+ */
+ friend void h5_read(h5::group fg, std::string const& name, sector_hamiltonian& s) {
+  using h5::h5_read;
+  auto gr = fg.open_group(name);
+  h5_read(gr, "occupations", s.occupations);
+  h5_read(gr, "space", s.space);
+  h5_read(gr, "matrix", s.matrix);
+ }
+};
+
+/// Build the sparse matrix of an operator in a sector
+/**
+  The element in row `f` and column `i` is `<f|h|i>`.
+  The operator is compiled into bit masks once; its action on the basis states, i.e. the columns of the matrix,
+  is then computed in parallel (OpenMP) by blocks, each block collecting its elements in its own buffer,
+  and the columns are finally transposed into rows.
+  Duplicated elements are summed up, and vanishing elements are dropped.
+  The operator must leave the sector invariant.
+
+  @tparam ScalarType Type of the matrix elements, normally `double` (default) or `std::complex<double>`
+  @param h Operator
+  @param fops Fundamental operator set; must contain all index sequences met in `h`
+  @param space Sector
+  @return The matrix of `h` in the basis of `space`
+ */
+template <typename ScalarType = double>
+csr_matrix<ScalarType> make_csr_matrix(operators::many_body_operator const& h, fundamental_operator_set const& fops,
+                                       sub_hilbert_space const& space) {
+ using triqs::utility::is_zero;
+ using element_t = std::pair<uint64_t, ScalarType>;
+
+ std::vector<std::pair<ScalarType, details::compiled_monomial>> terms;
+ for (auto const& term : h) terms.emplace_back(ScalarType(term.coef), details::compiled_monomial{term.monomial, fops});
+
+ uint64_t dim = space.size();
+ constexpr uint64_t block_size = 1024;
+ long n_blocks = (dim + block_size - 1) / block_size;
+
+ struct block_t {
+  std::vector<uint64_t> col_nnz;
+  std::vector<element_t> elements; // (row, value) of the columns of the block, column after column
+  bool out_of_space = false;
+ };
+ std::vector<block_t> blocks(n_blocks);
+
+#pragma omp parallel for schedule(dynamic)
+ for (long b = 0; b < n_blocks; ++b) {
+  auto& bl = blocks[b];
+  std::vector<element_t> col;
+  for (uint64_t i = b * block_size; i < std::min(dim, (b + 1) * block_size); ++i) {
+   col.clear();
+   for (auto const& t : terms) {
+    fock_state_t f = space.get_fock_state(i);
+    bool sign_is_minus;
+    if (!t.second.apply(f, sign_is_minus)) continue;
+    if (!space.has_state(f)) {
+     bl.out_of_space = true;
+     continue;
+    }
+    col.emplace_back(space.get_state_index(f), sign_is_minus ? -t.first : t.first);
+   }
+   // The duplicates are summed up
+   std::sort(col.begin(), col.end(), [](element_t const& x, element_t const& y) { return x.first < y.first; });
+   uint64_t n = 0;
+   for (auto it = col.begin(); it != col.end();) {
+    element_t e = *it;
+    for (++it; it != col.end() && it->first == e.first; ++it) e.second += it->second;
+    if (is_zero(e.second)) continue;
+    bl.elements.push_back(e);
+    ++n;
+   }
+   bl.col_nnz.push_back(n);
+  }
+ }
+ for (auto const& bl : blocks)
+  if (bl.out_of_space) TRIQS_RUNTIME_ERROR << "make_csr_matrix : the operator does not leave the sector invariant";
+
+ // Transpose the columns into rows. The columns are visited in increasing order, so the rows come out sorted.
+ csr_matrix<ScalarType> m;
+ m.n_rows = m.n_cols = dim;
+ m.row_ptr.assign(dim + 1, 0);
+ for (auto const& bl : blocks)
+  for (auto const& e : bl.elements) ++m.row_ptr[e.first + 1];
+ for (uint64_t f = 0; f < dim; ++f) m.row_ptr[f + 1] += m.row_ptr[f];
+ m.col_index.resize(m.row_ptr[dim]);
+ m.values.resize(m.row_ptr[dim]);
+
+ std::vector<uint64_t> next(m.row_ptr.begin(), m.row_ptr.end() - 1);
+ uint64_t i = 0;
+ for (auto& bl : blocks) {
+  auto it = bl.elements.cbegin();
+  for (auto n : bl.col_nnz) {
+   for (auto end = it + n; it != end; ++it) {
+    uint64_t k = next[it->first]++;
+    m.col_index[k] = i;
+    m.values(k) = it->second;
+   }
+   ++i;
+  }
+  std::vector<uint64_t>{}.swap(bl.col_nnz);
+  std::vector<element_t>{}.swap(bl.elements);
+ }
+ return m;
+}
+
+/// Build the sparse Hamiltonian in every sector with fixed occupations of groups of operators
+/**
+  The quantum numbers are the occupations of disjoint groups of fundamental operators, e.g.
+  `{up operators, down operators}` for the conservation of the number of particles `N = N_up + N_dn`
+  and of the spin projection `S_z = (N_up - N_dn) / 2`. With no group, the total number of particles is used.
+  The basis of each sector is enumerated directly ([[make_sector]]), so the full Hilbert space is never
+  explored, and each matrix is built by [[make_csr_matrix]].
+
+  Every monomial of `h` must conserve the occupation of every group; the sectors are returned in the order of
+  increasing occupations (the occupation of the last group running fastest), with their position as subspace index.
+
+  @tparam ScalarType Type of the matrix elements, normally `double` (default) or `std::complex<double>`
+  @param h Hamiltonian
+  @param fops Fundamental operator set; must contain all index sequences met in `h`
+  @param groups Disjoint groups of index sequences, whose occupations are conserved by `h`
+  @return The list of all sectors
+ */
+template <typename ScalarType = double>
+std::vector<sector_hamiltonian<ScalarType>>
+make_sector_hamiltonians(operators::many_body_operator const& h, fundamental_operator_set const& fops,
+                         std::vector<std::vector<fundamental_operator_set::indices_t>> const& groups = {}) {
+
+ if (groups.empty()) {
+  std::vector<sector_hamiltonian<ScalarType>> res;
+  for (int n = 0; n <= fops.size(); ++n) {
+   auto sp = make_particle_number_sector(fops, n, n);
+   res.push_back({{n}, sp, make_csr_matrix<ScalarType>(h, fops, sp)});
+  }
+  return res;
+ }
+
+ // Check the conservation laws on the monomials
+ std::vector<fock_state_t> group_masks;
+ for (auto const& g : groups) {
+  fock_state_t mask = 0;
+  for (auto const& ind : g) mask |= fock_state_t(1) << fops[ind];
+  group_masks.push_back(mask);
+ }
+ for (auto const& term : h) {
+  details::compiled_monomial m{term.monomial, fops};
+  for (auto mask : group_masks)
+   if (count_number_of_bits(m.dag_mask & mask) != count_number_of_bits(m.d_mask & mask))
+    TRIQS_RUNTIME_ERROR << "make_sector_hamiltonians : the operator does not conserve the occupation of a group of operators";
+ }
+
+ // Loop over all occupations
+ std::vector<sector_hamiltonian<ScalarType>> res;
+ std::vector<int> occ(groups.size(), 0);
+ while (true) {
+  std::vector<occupation_constraint_t> constraints;
+  for (int g = 0; g < groups.size(); ++g) constraints.emplace_back(groups[g], occ[g]);
+  auto sp = make_sector(fops, constraints, res.size());
+  res.push_back({occ, sp, make_csr_matrix<ScalarType>(h, fops, sp)});
+  int g = groups.size() - 1;
+  for (; g >= 0 && occ[g] == groups[g].size(); --g) occ[g] = 0;
+  if (g < 0) break;
+  ++occ[g];
+ }
+ return res;
+}
+}}
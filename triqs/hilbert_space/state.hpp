@@ -103,20 +103,20 @@ class state<HilbertSpace, ScalarType, true> : boost::additive<state<HilbertSpace
  /**
    @return Dimension of the associated Hilbert space
   */
- int size() const { return hs_p->size(); }
+ uint64_t size() const { return hs_p->size(); }
 
  /// Access to individual amplitudes
  /**
    @param i index of the requested amplitude
    @return Reference to the requested amplitude
   */
- value_type& operator()(int i) { return ampli[i]; }
+ value_type& operator()(uint64_t i) { return ampli[i]; }
  /// Access to individual amplitudes
  /**
    @param i index of the requested amplitude
    @return Constant reference to the requested amplitude
   */
- value_type const& operator()(int i) const { return ampli[i]; }
+ value_type const& operator()(uint64_t i) const { return ampli[i]; }
 
  /// In-place addition of another state
  /**
@@ -253,20 +253,20 @@ class state<HilbertSpace, ScalarType, false> : boost::additive<state<HilbertSpac
  /**
    @return Dimension of the associated Hilbert space
   */
- int size() const { return hs_p->size(); }
+ uint64_t size() const { return hs_p->size(); }
 
  /// Access to individual amplitudes
  /**
    @param i index of the requested amplitude
    @return Reference to the requested amplitude
   */
- value_type& operator()(int i) { return ampli[i]; }
+ value_type& operator()(uint64_t i) { return ampli[i]; }
  /// Access to individual amplitudes
  /**
    @param i index of the requested amplitude
    @return Constant reference to the requested amplitude
   */
- value_type const& operator()(int i) const { return ampli[i]; }
+ value_type const& operator()(uint64_t i) const { return ampli[i]; }
 
  /// In-place addition of another state
  /**
@@ -365,7 +365,7 @@ std::ostream& operator<<(std::ostream& os, state<HilbertSpace, ScalarType, Based
  auto const& hs = s.get_hilbert();
 
  using value_type = typename state<HilbertSpace, ScalarType, BasedOnMap>::value_type;
- foreach(s, [&os,hs,&something_written](int i, value_type ampl){
+ foreach(s, [&os,hs,&something_written](uint64_t i, value_type ampl){
   using triqs::utility::is_zero;
   if (!is_zero(ampl)){
    os << " +(" << ampl << ")" << "|" << hs.get_fock_state(i) << ">";
@@ -383,7 +383,7 @@ template<typename TargetState, typename OriginalState>
 TargetState project(OriginalState const& psi, hilbert_space const& proj_hs) {
  TargetState proj_psi(proj_hs);
  auto const& hs = psi.get_hilbert();
- foreach(psi,[&](int i, typename OriginalState::value_type v){
+ foreach(psi,[&](uint64_t i, typename OriginalState::value_type v){
   proj_psi(hs.get_fock_state(i)) = v;
  });
  return proj_psi;
@@ -393,7 +393,7 @@ template<typename TargetState, typename OriginalState>
 TargetState project(OriginalState const& psi, sub_hilbert_space const& proj_hs) {
  TargetState proj_psi(proj_hs);
  auto const& hs = psi.get_hilbert();
- foreach(psi,[&](int i, typename OriginalState::value_type v){
+ foreach(psi,[&](uint64_t i, typename OriginalState::value_type v){
   auto f = hs.get_fock_state(i);
   if(proj_hs.has_state(f)) proj_psi(proj_hs.get_state_index(f)) = v;
  });
@@ -404,13 +404,13 @@ TargetState project(OriginalState const& psi, sub_hilbert_space const& proj_hs)
 // Not needed for clang 3.5
 template<typename A, typename B> struct __lambda1 {
  A& proj_psi; B const & hs;
- template<typename VT> void operator()(int i, VT const & v) {
+ template<typename VT> void operator()(uint64_t i, VT const & v) {
  proj_psi(hs.get_fock_state(i)) = v;
  }
 };
 template<typename A, typename B, typename C> struct __lambda2 {
  A& proj_psi; B const & proj_hs; C const & hs;
- template<typename VT> void operator()(int i, VT const & v) {
+ template<typename VT> void operator()(uint64_t i, VT const & v) {
   auto f = hs.get_fock_state(i);
   if (proj_hs.has_state(f)) proj_psi(proj_hs.get_state_index(f)) = v;
  }
@@ -23,7 +23,10 @@
 
 #include <ostream>
 #include <cmath>
+#include <unordered_map>
+#include <algorithm>
 #include <boost/operators.hpp>
+#include <boost/functional/hash.hpp>
 #include <triqs/utility/real_or_complex.hpp>
 #include <triqs/utility/numeric_ops.hpp>
 #include <triqs/h5.hpp>
@@ -236,18 +239,62 @@ namespace operators {
   }
 
   many_body_operator_generic& operator*=(many_body_operator_generic const& op) {
-   monomials_map_t tmp_map; // product will be stored here
-   for (auto const& m : monomials)
-    for (auto const& op_m : op.monomials) {
+   // Small products (e.g. c_dag(i) * c(j) when building a Hamiltonian term by term) are cheaper
+   // directly on the map : interning only pays off from a few products on.
+   if (monomials.size() * op.monomials.size() < interned_product_threshold) {
+    monomials_map_t tmp_map; // product will be stored here
+    monomial_t product_m;
+    for (auto const& m : monomials)
+     for (auto const& op_m : op.monomials) {
+      // prepare an unnormalized product
+      product_m.clear();
+      product_m.insert(product_m.end(), m.first.begin(), m.first.end());
+      product_m.insert(product_m.end(), op_m.first.begin(), op_m.first.end());
+      normalize_and_insert(product_m, m.second * op_m.second, tmp_map);
+     }
+    std::swap(monomials, tmp_map);
+    return *this;
+   }
+
+   // The indices of the canonical operators of both factors are first interned into small integers.
+   // The products are then normalized and accumulated on plain integer monomials in a hash map,
+   // and converted back to monomial_t only once per resulting monomial.
+   interning_table table;
+   for (auto const* x : std::initializer_list<monomials_map_t const*>{&monomials, &op.monomials})
+    for (auto const& m : *x)
+     for (auto const& c_cdag_op : m.first) table.indices.push_back(&c_cdag_op.indices);
+   table.sort();
+
+   std::vector<std::pair<interned_monomial_t, scalar_t>> lhs, rhs;
+   lhs.reserve(monomials.size());
+   rhs.reserve(op.monomials.size());
+   for (auto const& m : monomials) lhs.emplace_back(table.intern(m.first), m.second);
+   for (auto const& m : op.monomials) rhs.emplace_back(table.intern(m.first), m.second);
+
+   interned_map_t products;
+   interned_monomial_t product_m;
+   for (auto const& m : lhs)
+    for (auto const& op_m : rhs) {
      // prepare an unnormalized product
-     monomial_t product_m;
-     product_m.reserve(m.first.size() + op_m.first.size());
-     for (auto const& op : m.first) product_m.push_back(op);
-     for (auto const& op : op_m.first) product_m.push_back(op);
-     // std::copy(m.first.begin(), m.first.end(), std::back_inserter(product_m));
-     // std::copy(op_m.first.begin(), op_m.first.end(), std::back_inserter(product_m));
-     normalize_and_insert(product_m, m.second * op_m.second, tmp_map);
+     product_m.clear();
+     product_m.insert(product_m.end(), m.first.begin(), m.first.end());
+     product_m.insert(product_m.end(), op_m.first.begin(), op_m.first.end());
+     normalize_and_insert(product_m, m.second * op_m.second, table.n_keys(), products);
     }
+
+   // back to monomial_t, in the order of the map to build it in linear time
+   std::vector<typename interned_map_t::const_iterator> sorted;
+   sorted.reserve(products.size());
+   for (auto it = products.cbegin(); it != products.cend(); ++it) {
+    using triqs::utility::is_zero;
+    if (!is_zero(it->second)) sorted.push_back(it);
+   }
+   std::sort(sorted.begin(), sorted.end(), [](typename interned_map_t::const_iterator const& a,
+                                              typename interned_map_t::const_iterator const& b) {
+    return a->first.size() != b->first.size() ? a->first.size() < b->first.size() : a->first < b->first;
+   });
+   monomials_map_t tmp_map;
+   for (auto const& it : sorted) tmp_map.emplace_hint(tmp_map.end(), table.extern_(it->first), it->second);
    std::swap(monomials, tmp_map);
    return *this;
   }
@@ -280,6 +327,45 @@ namespace operators {
   template <class Archive> void serialize(Archive& ar, const unsigned int version) { ar& monomials; }
 
   private:
+  // Number of products of monomials above which operator*= works on interned indices
+  static constexpr std::size_t interned_product_threshold = 4;
+
+  // Monomial with interned canonical operators (see interning_table)
+  using interned_monomial_t = std::vector<int>;
+  using interned_map_t = std::unordered_map<interned_monomial_t, scalar_t, boost::hash<interned_monomial_t>>;
+
+  // Correspondance between the indices of the canonical operators and small integers (keys).
+  // With K distinct indices sorted in increasing order, C^+_i has key i and C_i has key 2K-1-i,
+  // so that the order of the keys is the order of the canonical operators (Cf canonical_ops_t),
+  // and the Hermitian conjugate of the operator of key k has key 2K-1-k.
+  struct interning_table {
+   std::vector<indices_t const*> indices;
+   static bool less(indices_t const* a, indices_t const* b) {
+    return std::lexicographical_compare(a->begin(), a->end(), b->begin(), b->end());
+   }
+   static bool equal(indices_t const* a, indices_t const* b) { return *a == *b; }
+   void sort() {
+    std::sort(indices.begin(), indices.end(), less);
+    indices.erase(std::unique(indices.begin(), indices.end(), equal), indices.end());
+   }
+   int n_keys() const { return 2 * indices.size(); }
+   interned_monomial_t intern(monomial_t const& m) const {
+    interned_monomial_t r;
+    r.reserve(m.size());
+    for (auto const& c_cdag_op : m) {
+     int i = std::lower_bound(indices.begin(), indices.end(), &c_cdag_op.indices, less) - indices.begin();
+     r.push_back(c_cdag_op.dagger ? i : n_keys() - 1 - i);
+    }
+    return r;
+   }
+   monomial_t extern_(interned_monomial_t const& m) const {
+    monomial_t r;
+    r.reserve(m.size());
+    for (int k : m) r.push_back(k < int(indices.size()) ? canonical_ops_t{true, *indices[k]} : canonical_ops_t{false, *indices[n_keys() - 1 - k]});
+    return r;
+   }
+  };
+
   // Normalize a monomial and insert into a map
   static void normalize_and_insert(monomial_t& m, scalar_t coeff, monomials_map_t& target) {
    // The normalization is done by employing a simple bubble sort algorithms.
@@ -296,10 +382,7 @@ namespace operators {
       if (prev_index == cur_index) return; // The monomial is effectively zero
       if (prev_index > cur_index) {
        // Are we swapping C and C^+ with the same indices?
-       // A bit ugly ...
-       canonical_ops_t cur_index_flipped_type(cur_index);
-       cur_index_flipped_type.dagger = !cur_index_flipped_type.dagger;
-       if (prev_index == cur_index_flipped_type) {
+       if (prev_index.dagger != cur_index.dagger && prev_index.indices == cur_index.indices) {
         monomial_t new_m;
         new_m.reserve(m.size() - 2);
         std::copy(m.begin(), m.begin() + n - 1, std::back_inserter(new_m));
@@ -324,6 +407,42 @@ namespace operators {
    }
   }
 
+  // Normalize an interned monomial and insert into a map
+  static void normalize_and_insert(interned_monomial_t& m, scalar_t coeff, int n_keys, interned_map_t& target) {
+   // The normalization is done by employing a simple bubble sort algorithms.
+   // Apart from sorting elements this function keeps track of the sign and
+   // recursively calls itself if a permutation of two operators produces a new
+   // monomial
+   if (m.size() >= 2) {
+    bool is_swapped;
+    do {
+     is_swapped = false;
+     for (std::size_t n = 1; n < m.size(); ++n) {
+      int& prev_index = m[n - 1];
+      int& cur_index = m[n];
+      if (prev_index == cur_index) return; // The monomial is effectively zero
+      if (prev_index > cur_index) {
+       // Are we swapping C and C^+ with the same indices?
+       if (prev_index == n_keys - 1 - cur_index) {
+        interned_monomial_t new_m;
+        new_m.reserve(m.size() - 2);
+        std::copy(m.begin(), m.begin() + n - 1, std::back_inserter(new_m));
+        std::copy(m.begin() + n + 1, m.end(), std::back_inserter(new_m));
+        normalize_and_insert(new_m, coeff, n_keys, target);
+       }
+       coeff = -coeff;
+       std::swap(prev_index, cur_index);
+       is_swapped = true;
+      }
+     }
+    } while (is_swapped);
+   }
+
+   // Insert the result
+   auto r = target.insert(std::make_pair(m, coeff));
+   if (!r.second) r.first->second += coeff;
+  }
+
   // Erase a monomial with a close-to-zero coefficient.
   static void erase_zero_monomial(monomials_map_t& m, typename monomials_map_t::iterator& it) {
    using triqs::utility::is_zero;
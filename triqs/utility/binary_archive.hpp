@@ -0,0 +1,285 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2016 by O. Parcollet
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./first_include.hpp"
+#include "./c17.hpp"
+#include "./exceptions.hpp"
+#include "./is_complex.hpp"
+#include <boost/serialization/serialization.hpp>
+#include <boost/mpl/bool.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+
+namespace triqs {
+namespace utility {
+
+ namespace binary_archive_impl {
+
+  // Header of the archive : magic number, version of the format, check of the endianness
+  constexpr std::uint32_t magic = 0x51425254; // "TRBQ"
+  constexpr std::uint32_t format_version = 1;
+  constexpr std::uint32_t endianness = 0x01020304;
+
+  // the types written as their bytes
+  template <typename T>
+  using is_raw = std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value || triqs::is_complex<T>::value>;
+
+  // the elements of a vector written as one block
+  template <typename T> using is_block = std::integral_constant<bool, is_raw<T>::value && !std::is_same<T, bool>::value>;
+
+  // The hooks binary_save(ar, x) and binary_load(ar, x), found by ADL, e.g. for the arrays
+  template <typename Ar, typename T, typename = void> struct has_save_hook : std::false_type {};
+  template <typename Ar, typename T>
+  struct has_save_hook<Ar, T, std17::void_t<decltype(binary_save(std::declval<Ar &>(), std::declval<T const &>()))>> : std::true_type {};
+
+  template <typename Ar, typename T, typename = void> struct has_load_hook : std::false_type {};
+  template <typename Ar, typename T>
+  struct has_load_hook<Ar, T, std17::void_t<decltype(binary_load(std::declval<Ar &>(), std::declval<T &>()))>> : std::true_type {};
+ }
+
+ /// Binary output archive, with the interface of the boost archives (<<, &)
+ /**
+  * The numbers are written as their bytes, the vectors (and contiguous arrays) of numbers as a single block of memory,
+  * the other objects through their boost serialize method (or the hook binary_save(ar, x) if found by ADL).
+  * The archive starts with a header : the version of the format and a check of the endianness.
+  * It is meant for the communication between the nodes and the checkpoints, not for long term storage (use h5 for that) :
+  * the format depends on the size of the basic types of the machine.
+  */
+ class binary_oarchive {
+  std::string &buf;
+
+  public:
+  using is_saving = boost::mpl::true_;
+  using is_loading = boost::mpl::false_;
+
+  /// Append to buf
+  binary_oarchive(std::string &buf) : buf(buf) {
+   *this << binary_archive_impl::magic << binary_archive_impl::format_version << binary_archive_impl::endianness;
+  }
+
+  template <typename T> binary_oarchive &operator<<(T const &x) {
+   save(x);
+   return *this;
+  }
+
+  template <typename T> binary_oarchive &operator&(T const &x) { return *this << x; }
+
+  /// Write n bytes at p
+  void save_bytes(void const *p, std::size_t n) { buf.append(static_cast<char const *>(p), n); }
+
+  /// Write a size
+  void save_size(std::size_t n) { save(std::uint64_t(n)); }
+
+  private:
+  template <typename T> std14::enable_if_t<binary_archive_impl::is_raw<T>::value> save(T const &x) { save_bytes(&x, sizeof(T)); }
+
+  void save(std::string const &s) {
+   save_size(s.size());
+   save_bytes(s.data(), s.size());
+  }
+
+  template <typename T, typename A> void save(std::vector<T, A> const &v) {
+   save_size(v.size());
+   save_elements(v, binary_archive_impl::is_block<T>{});
+  }
+
+  template <typename V> void save_elements(V const &v, std::true_type) { save_bytes(v.data(), v.size() * sizeof(typename V::value_type)); }
+  template <typename V> void save_elements(V const &v, std::false_type) {
+   for (auto const &x : v) *this << static_cast<typename V::value_type const &>(x);
+  }
+
+  template <typename T, std::size_t N> void save(T const (&x)[N]) {
+   for (std::size_t i = 0; i < N; ++i) *this << x[i];
+  }
+
+  template <typename A, typename B> void save(std::pair<A, B> const &x) { *this << x.first << x.second; }
+
+  template <typename K, typename V, typename C, typename A> void save(std::map<K, V, C, A> const &m) {
+   save_size(m.size());
+   for (auto const &x : m) *this << x.first << x.second;
+  }
+
+  template <typename T>
+  std14::enable_if_t<std::is_class<T>::value && !binary_archive_impl::is_raw<T>::value> save(T const &x) {
+   save_object(x, binary_archive_impl::has_save_hook<binary_oarchive, T>{});
+  }
+
+  template <typename T> void save_object(T const &x, std::true_type) { binary_save(*this, x); }
+  template <typename T> void save_object(T const &x, std::false_type) {
+   boost::serialization::serialize_adl(*this, const_cast<T &>(x), 0);
+  }
+ };
+
+ /// Binary input archive, reading what a binary_oarchive wrote. Cf binary_oarchive.
+ class binary_iarchive {
+  char const *p, *end;
+
+  public:
+  using is_saving = boost::mpl::false_;
+  using is_loading = boost::mpl::true_;
+
+  /// Read the n bytes at data. They are not copied, and must outlive the archive.
+  binary_iarchive(char const *data, std::size_t n) : p(data), end(data + n) {
+   std::uint32_t m = 0, v = 0, e = 0;
+   *this >> m >> v >> e;
+   if (m != binary_archive_impl::magic) TRIQS_RUNTIME_ERROR << "binary_iarchive : the data is not a binary archive";
+   if (v > binary_archive_impl::format_version)
+    TRIQS_RUNTIME_ERROR << "binary_iarchive : the archive has the format " << v << ", more recent than this version of triqs ("
+                        << binary_archive_impl::format_version << ")";
+   if (e != binary_archive_impl::endianness) TRIQS_RUNTIME_ERROR << "binary_iarchive : the archive was written with another endianness";
+  }
+
+  ///
+  binary_iarchive(std::string const &buf) : binary_iarchive(buf.data(), buf.size()) {}
+
+  template <typename T> binary_iarchive &operator>>(T &x) {
+   load(x);
+   return *this;
+  }
+
+  template <typename T> binary_iarchive &operator&(T &x) { return *this >> x; }
+
+  /// Read n bytes into q
+  void load_bytes(void *q, std::size_t n) {
+   if (std::size_t(end - p) < n) TRIQS_RUNTIME_ERROR << "binary_iarchive : unexpected end of the archive";
+   std::memcpy(q, p, n);
+   p += n;
+  }
+
+  /// Read a size
+  std::size_t load_size() {
+   std::uint64_t n;
+   load(n);
+   return n;
+  }
+
+  /// Number of bytes not yet read
+  std::size_t remaining() const { return end - p; }
+
+  /// Check that n elements of element_bytes bytes each are left in the archive, before allocating them
+  void check_remaining(std::size_t n, std::size_t element_bytes) const {
+   if (element_bytes > 0 && n > remaining() / element_bytes)
+    TRIQS_RUNTIME_ERROR << "binary_iarchive : unexpected end of the archive (" << n << " elements of " << element_bytes
+                        << " bytes announced, " << remaining() << " bytes left)";
+  }
+
+  private:
+  template <typename T> std14::enable_if_t<binary_archive_impl::is_raw<T>::value> load(T &x) { load_bytes(&x, sizeof(T)); }
+
+  // A corrupted or truncated archive may announce any size : it is checked before the allocation
+  void load(std::string &s) {
+   std::size_t n = load_size();
+   check_remaining(n, 1);
+   s.resize(n);
+   if (!s.empty()) load_bytes(&s[0], s.size());
+  }
+
+  template <typename T, typename A> void load(std::vector<T, A> &v) {
+   load_elements(v, load_size(), binary_archive_impl::is_block<T>{});
+  }
+
+  template <typename V> void load_elements(V &v, std::size_t n, std::true_type) {
+   check_remaining(n, sizeof(typename V::value_type));
+   v.resize(n);
+   load_bytes(v.data(), n * sizeof(typename V::value_type));
+  }
+
+  // The size of the elements in the archive is not known : they are read one by one
+  template <typename V> void load_elements(V &v, std::size_t n, std::false_type) {
+   v.clear();
+   v.reserve(std::min(n, remaining()));
+   for (std::size_t i = 0; i < n; ++i) {
+    typename V::value_type x;
+    *this >> x;
+    v.push_back(std::move(x));
+   }
+  }
+
+  template <typename T, std::size_t N> void load(T (&x)[N]) {
+   for (std::size_t i = 0; i < N; ++i) *this >> x[i];
+  }
+
+  template <typename A, typename B> void load(std::pair<A, B> &x) { *this >> x.first >> x.second; }
+
+  template <typename K, typename V, typename C, typename A> void load(std::map<K, V, C, A> &m) {
+   m.clear();
+   std::size_t n = load_size();
+   for (std::size_t i = 0; i < n; ++i) {
+    std::pair<K, V> x;
+    *this >> x;
+    m.insert(m.end(), std::move(x));
+   }
+  }
+
+  template <typename T> std14::enable_if_t<std::is_class<T>::value && !binary_archive_impl::is_raw<T>::value> load(T &x) {
+   load_object(x, binary_archive_impl::has_load_hook<binary_iarchive, T>{});
+  }
+
+  template <typename T> void load_object(T &x, std::true_type) { binary_load(*this, x); }
+  template <typename T> void load_object(T &x, std::false_type) { boost::serialization::serialize_adl(*this, x, 0); }
+ };
+
+ /// Serialize x into a string, with a binary_oarchive
+ template <typename T> std::string binary_serialize(T const &x) {
+  std::string buf;
+  binary_oarchive ar(buf);
+  ar << x;
+  return buf;
+ }
+
+ /// Deserialize a string written by binary_serialize
+ template <typename T> T binary_deserialize(std::string const &buf) {
+  T x;
+  binary_iarchive ar(buf);
+  ar >> x;
+  return x;
+ }
+
+ /// Deserialize a string written by binary_serialize into x, e.g. a view (of the correct size)
+ template <typename T> void binary_deserialize_into(std::string const &buf, T &&x) {
+  binary_iarchive ar(buf);
+  ar >> x;
+ }
+}
+
+namespace mpi {
+
+ /// Broadcast any object which can be written in a binary archive (e.g. a many_body_operator, a tail, parameters)
+ /**
+  * The object is serialized on the root, the bytes are broadcast, and deserialized on the other nodes.
+  */
+ template <typename T> void mpi_broadcast_binary(T &x, communicator c = {}, int root = 0) {
+  std::string buf;
+  if (c.rank() == root) buf = utility::binary_serialize(x);
+  long n = buf.size();
+  mpi_broadcast(n, c, root);
+  if (c.rank() != root) buf.resize(n);
+  const long chunk = 1l << 30; // the count of MPI_Bcast is an int
+  for (long i = 0; i < n; i += chunk) MPI_Bcast(&buf[i], int(std::min(chunk, n - i)), MPI_CHAR, root, c.get());
+  if (c.rank() != root) utility::binary_deserialize_into(buf, x);
+ }
+}
+}
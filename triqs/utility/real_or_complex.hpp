@@ -19,6 +19,7 @@
  *
  ******************************************************************************/
 #pragma once
+#include <triqs/utility/first_include.hpp>
 #include <triqs/utility/exceptions.hpp>
 #include <triqs/utility/numeric_ops.hpp>
 #include <complex>
@@ -42,6 +43,13 @@ namespace utility {
   real_or_complex(std::complex<double> x) : _x(std::move(x)), _is_real(false) {}
 
   bool is_real() const { return _is_real; }
+
+  // boost serialization
+  friend class boost::serialization::access;
+  template <class Archive> void serialize(Archive &ar, const unsigned int version) {
+   ar &TRIQS_MAKE_NVP("is_real", _is_real);
+   ar &TRIQS_MAKE_NVP("x", _x);
+  }
   
   explicit operator std::complex<double>() const { return _x; }
   
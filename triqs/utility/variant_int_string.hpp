@@ -22,6 +22,7 @@
 #include <triqs/utility/exceptions.hpp>
 #include <string>
 #include <boost/serialization/utility.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace triqs {
 namespace utility {
@@ -132,6 +133,16 @@ namespace utility {
    return (x.as_string == y.as_string);
   }
 
+  /// Hash value, consistent with operator== (found by boost::hash)
+  friend std::size_t hash_value(variant_int_string const &x) {
+   std::size_t seed = x.type;
+   if (x.type == Int)
+    boost::hash_combine(seed, x.as_int);
+   else
+    boost::hash_combine(seed, x.as_string);
+   return seed;
+  }
+
   // printing
 #ifdef TRIQS_CPP11
   struct print_visitor {